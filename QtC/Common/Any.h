@@ -12,102 +12,169 @@
 #include <type_traits>
 #include <utility>
 #include <typeinfo>
-#include <string>
-#include <cassert>
+#include <new>
 
 namespace QtC {
-  
-    // using StorageType = typename decay<typename remove_reference<T>::type>::type;
+
     template<class T>
-    using StorageType = typename decay<T>::type; 
-    
-    struct Any {
-        bool is_null() const { return !ptr; }
-        bool not_null() const { return ptr; }
-        
-        template<typename U> Any(U&& value)
-            : ptr(new Derived<StorageType<U>>(forward<U>(value)))
-        {}
-        
-        template<class U> bool is() const {
+    using StorageType = typename std::decay<T>::type;
+
+    /* Holds a value of any copyable type. Values that fit in three
+       pointers and move without throwing are stored inline, others on
+       the heap. Types are told apart by their table of operations, so
+       no RTTI is needed. */
+    class Any {
+        union Storage {
+            void *heap;
+            typename std::aligned_storage<3 * sizeof(void *), alignof(void *)>::type buffer;
+        };
+
+        struct Table {
+            void (*destroy)(Storage &aStorage);
+            void (*copy)(const Storage &aFrom, Storage &aTo);
+            void (*move)(Storage &aFrom, Storage &aTo); // also destroys aFrom
+        };
+
+        template<class T>
+        struct Inline : std::integral_constant<bool,
+                                               sizeof(T) <= sizeof(Storage) &&
+                                               alignof(Storage) % alignof(T) == 0 &&
+                                               std::is_nothrow_move_constructible<T>::value> {};
+
+        template<class T, bool = Inline<T>::value>
+        struct Handler;
+
+        template<class U>
+        using NotAny = typename std::enable_if<!std::is_same<StorageType<U>, Any>::value>::type;
+    public:
+        Any() noexcept : iTable(nullptr) {}
+
+        template<typename U, typename = NotAny<U>>
+        Any(U&& aValue) : iTable(nullptr) {
             typedef StorageType<U> T;
-            auto derived = dynamic_cast<Derived<T>*> (ptr);
-            return derived;
+            Handler<T>::construct(iStorage, std::forward<U>(aValue));
+            iTable = &Handler<T>::table;
+        }
+
+        Any(const Any& aOther) : iTable(nullptr) {
+            if (aOther.iTable) {
+                aOther.iTable->copy(aOther.iStorage, iStorage);
+                iTable = aOther.iTable;
+            }
+        }
+        Any(Any&& aOther) noexcept : iTable(nullptr) { moveFrom(aOther); }
+
+        Any& operator=(const Any& aOther) {
+            if (this != &aOther) {
+                Any copy(aOther);
+                reset();
+                moveFrom(copy);
+            }
+            return *this;
+        }
+        Any& operator=(Any&& aOther) noexcept {
+            if (this != &aOther) {
+                reset();
+                moveFrom(aOther);
+            }
+            return *this;
+        }
+
+        ~Any() { reset(); }
+
+        bool is_null() const noexcept { return !iTable; }
+        bool not_null() const noexcept { return iTable != nullptr; }
+
+        void reset() noexcept {
+            if (iTable) {
+                iTable->destroy(iStorage);
+                iTable = nullptr;
+            }
         }
-        
+
+        template<class U> bool is() const noexcept {
+            return iTable == &Handler<StorageType<U>>::table;
+        }
+
         template<class U>
         StorageType<U>& as() {
-            typedef StorageType<U> T;
-            
-            auto derived = dynamic_cast<Derived<T>*> (ptr);
-            
-            if (!derived)
-                throw bad_cast();
-            
-            return derived->value;
+            if (!is<U>())
+                throw std::bad_cast();
+            return *Handler<StorageType<U>>::get(iStorage);
         }
-        
+
         template<class U>
-        operator U() {
+        const StorageType<U>& as() const {
+            if (!is<U>())
+                throw std::bad_cast();
+            return *Handler<StorageType<U>>::get(iStorage);
+        }
+
+        template<class U>
+        operator U() const {
             return as<StorageType<U>>();
         }
-        
-        Any() : ptr(nullptr) {}
-        Any(Any& that) : ptr(that.clone()) {}
-        Any(Any&& that) : ptr(that.ptr) { that.ptr = nullptr; }
-        Any(const Any& that) : ptr(that.clone()) { }
-        Any(const Any&& that) : ptr(that.clone()) { }
-        Any& operator=(const Any& a) {
-            if (ptr == a.ptr)
-                return *this;
-            
-            auto old_ptr = ptr;
-            
-            ptr = a.clone();
-            
-            if (old_ptr)
-                delete old_ptr;
-            
-            return *this;
+    private:
+        void moveFrom(Any &aOther) noexcept {
+            if (aOther.iTable) {
+                aOther.iTable->move(aOther.iStorage, iStorage);
+                iTable = aOther.iTable;
+                aOther.iTable = nullptr;
+            }
         }
-        Any& operator=(Any&& a) {
-            if (ptr == a.ptr)
-                return *this;
-            
-            swap(ptr, a.ptr);
-            
-            return *this;
+    private:
+        const Table *iTable;
+        Storage iStorage;
+    };
+
+    /*
+    ** Any - Handlers
+    */
+    template<class T>
+    struct Any::Handler<T, true> {
+        static T* get(Storage &aStorage) { return reinterpret_cast<T*>(&aStorage.buffer); }
+        static const T* get(const Storage &aStorage) { return reinterpret_cast<const T*>(&aStorage.buffer); }
+
+        template<class U>
+        static void construct(Storage &aStorage, U&& aValue) {
+            new (&aStorage.buffer) T(std::forward<U>(aValue));
         }
-        
-        ~Any() {
-            if (ptr)
-                delete ptr;
+        static void destroy(Storage &aStorage) { get(aStorage)->~T(); }
+        static void copy(const Storage &aFrom, Storage &aTo) { new (&aTo.buffer) T(*get(aFrom)); }
+        static void move(Storage &aFrom, Storage &aTo) {
+            new (&aTo.buffer) T(std::move(*get(aFrom)));
+            get(aFrom)->~T();
         }
-    private:
-        struct Base {
-            virtual ~Base() {}
-            virtual Base* clone() const = 0;
-        };
-        
-        template<typename T>
-        struct Derived : Base {
-            template<typename U> Derived(U&& value) : value(forward<U>(value)) { }
-            
-            T value;
-            
-            Base* clone() const { return new Derived<T>(value); }
-        };
-        
-        Base* clone() const {
-            if (ptr)
-                return ptr->clone();
-            else
-                return nullptr;
+
+        static const Table table;
+    };
+
+    template<class T>
+    struct Any::Handler<T, false> {
+        static T* get(Storage &aStorage) { return static_cast<T*>(aStorage.heap); }
+        static const T* get(const Storage &aStorage) { return static_cast<const T*>(aStorage.heap); }
+
+        template<class U>
+        static void construct(Storage &aStorage, U&& aValue) {
+            aStorage.heap = new T(std::forward<U>(aValue));
         }
-        
-        Base* ptr;
+        static void destroy(Storage &aStorage) { delete get(aStorage); }
+        static void copy(const Storage &aFrom, Storage &aTo) { aTo.heap = new T(*get(aFrom)); }
+        static void move(Storage &aFrom, Storage &aTo) { aTo.heap = aFrom.heap; }
+
+        static const Table table;
     };
-    
+
+    template<class T>
+    const Any::Table Any::Handler<T, true>::table = {
+        &Any::Handler<T, true>::destroy, &Any::Handler<T, true>::copy, &Any::Handler<T, true>::move
+    };
+
+    template<class T>
+    const Any::Table Any::Handler<T, false>::table = {
+        &Any::Handler<T, false>::destroy, &Any::Handler<T, false>::copy, &Any::Handler<T, false>::move
+    };
+
 } /* namespace QtC */
 
 #endif /* QTC_COMMON_ANY_H */
@@ -10,50 +10,122 @@
 #define QTC_COMMON_BASE64_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <string>
 #include <iostream>
 
+#include <boost/asio/buffer.hpp>
+
 namespace QtC {
-  
+
   namespace Base64 {
-  
+
+    /* Length of the padded encoding of aLength bytes. */
+    inline size_t encodedLength(size_t aLength) { return (aLength + 2) / 3 * 4; }
+    /* Upper bound of the bytes decoded from aLength characters. */
+    inline size_t decodedLength(size_t aLength) { return (aLength + 3) / 4 * 3; }
+
+    /* Span API: no allocation and no line breaks, vectorized (SSSE3/AVX2)
+       when the processor has it. aOutput must hold encodedLength(aLength)
+       or decodedLength(aLength) bytes. Decoding skips characters outside
+       of the alphabet, like the Decoder. Both return the bytes written. */
+    size_t encode(const char *aInput, size_t aLength, char *aOutput);
+    size_t decode(const char *aInput, size_t aLength, char *aOutput);
+
+    enum Alphabet {
+      Standard,                 // RFC 4648 section 4: '+' and '/'
+      URLSafe                   // RFC 4648 section 5: '-' and '_'
+    };
+
+    struct Options {
+      Options(Alphabet aAlphabet = Standard, size_t aLineLength = 0,
+              const char *aLineBreak = "\r\n", bool aPadding = true)
+        : alphabet(aAlphabet), lineLength(aLineLength),
+          lineBreak(aLineBreak), padding(aPadding)
+      {}
+
+      Alphabet alphabet;
+      size_t lineLength;        // characters per line, rounded down to a multiple of 4; 0 for none
+      const char *lineBreak;
+      bool padding;
+    };
+
+    /* Incremental encoder over caller buffers: input of any length is
+       accepted, groups split across calls are carried over. */
     class Encoder {
+    public:
       enum { CHARS_PER_LINE = 72 };
-      enum EncoderStep { StepA, StepB, StepC };
     public:
-      Encoder();
-    
-      int encodeBlock(const char* aInput, size_t aInputLength, char* aOutput);
-      int encodeBlockEnd(char* aOutput);
-    protected:  
-      char encodeValue(char aValueIn);
+      Encoder();                // CHARS_PER_LINE, '\n' line breaks
+      Encoder(const Options &aOptions);
+
+      /* Output space needed by encodeBlock(aLength bytes) and encodeBlockEnd(). */
+      size_t maxLength(size_t aLength) const;
+
+      size_t encodeBlock(const char* aInput, size_t aInputLength, char* aOutput);
+      template <class ConstBufferSequence>
+      size_t encodeBlock(const ConstBufferSequence &aBuffers, char* aOutput);
+      /* Flushes the last group with padding and resets the encoder. */
+      size_t encodeBlockEnd(char* aOutput);
+    private:
+      char *encodeGroups(const char* aInput, size_t aLength, char* aOutput);
     private:
-      EncoderStep iStep;
-      char iResult;
-      int iStepCount;
+      Options iOptions;
+      size_t iLineBreakLength;
+      size_t iColumn;
+      char iPending[3];
+      size_t iPendingLength;
     };
 
     void encode(std::istream& aInputStream, std::ostream& aOutputStream);
     std::string encode(const std::string &aInput);
-    
+
+    /* Incremental decoder, bytes are written as soon as they are
+       complete. Characters outside of the alphabet are skipped; the
+       URL-safe decoder also accepts '+' and '/'. */
     class Decoder {
-      enum DecoderStep { StepA, StepB, StepC, StepD };
     public:
-      Decoder();
-      int decodeBlock(const char* aInput, const int aInputLength, char* aOutput);
-    private:
-      int decodeValue(char aValue);
+      Decoder(Alphabet aAlphabet = Standard);
+
+      size_t maxLength(size_t aLength) const { return decodedLength(aLength); }
+
+      size_t decodeBlock(const char* aInput, size_t aInputLength, char* aOutput);
+      template <class ConstBufferSequence>
+      size_t decodeBlock(const ConstBufferSequence &aBuffers, char* aOutput);
     private:
-      DecoderStep iStep;
-      char	iPlainChar;
+      Alphabet iAlphabet;
+      uint32_t iBits;
+      int iCount;
     };
-    
+
     void decode(std::istream& aInputStream, std::ostream& aOutputStream);
     std::string decode(const std::string &aInput);
-  
+
+    template <class ConstBufferSequence>
+    size_t Encoder::encodeBlock(const ConstBufferSequence &aBuffers, char* aOutput) {
+      char* output = aOutput;
+      for (auto i = boost::asio::buffer_sequence_begin(aBuffers);
+           i != boost::asio::buffer_sequence_end(aBuffers); ++i) {
+        boost::asio::const_buffer buffer(*i);
+        output += encodeBlock((const char *)buffer.data(), buffer.size(), output);
+      }
+      return output - aOutput;
+    }
+
+    template <class ConstBufferSequence>
+    size_t Decoder::decodeBlock(const ConstBufferSequence &aBuffers, char* aOutput) {
+      char* output = aOutput;
+      for (auto i = boost::asio::buffer_sequence_begin(aBuffers);
+           i != boost::asio::buffer_sequence_end(aBuffers); ++i) {
+        boost::asio::const_buffer buffer(*i);
+        output += decodeBlock((const char *)buffer.data(), buffer.size(), output);
+      }
+      return output - aOutput;
+    }
+
   } /* namespace Base64 */
-    
+
 } /* namespace QtC */
 
 #endif /* QTC_COMMON_BASE64_H */
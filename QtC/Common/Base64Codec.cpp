@@ -0,0 +1,465 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/Base64Codec.cpp
+** Comment:    Vectorized Base64 codec with run time dispatch.
+*/
+
+#include <stdint.h>
+#include <cstring>
+
+#include "QtC/Common/CPU.h"
+#include "QtC/Common/Base64.h"
+
+#if defined(QTC_CPU_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace QtC {
+
+    namespace Base64 {
+
+        typedef void (*EncodeKernel)(const unsigned char *&p, const unsigned char *end, char *&q);
+        typedef void (*DecodeKernel)(const unsigned char *&p, const unsigned char *end, unsigned char *&q);
+
+        static const char gAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        static const char gAlphabetURLSafe[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+        /* Value of each character, -1 outside of the alphabet. */
+        static const signed char gDecode[256] = {
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63,
+            52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1,
+            -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,
+            15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
+            -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+            41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+        };
+
+        /* URL-safe values, '+' and '/' are accepted as well. */
+        static const signed char gDecodeURLSafe[256] = {
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,62,-1,63,
+            52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1,
+            -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,
+            15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,63,
+            -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+            41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+        };
+
+        /*
+        ** Scalar, whole groups of 3 bytes / 4 characters
+        */
+        static void encodeScalar(const unsigned char *&p, const unsigned char *end, char *&q) {
+            for (; end - p >= 3; p += 3, q += 4) {
+                uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+                q[0] = gAlphabet[v >> 18];
+                q[1] = gAlphabet[(v >> 12) & 0x3f];
+                q[2] = gAlphabet[(v >> 6) & 0x3f];
+                q[3] = gAlphabet[v & 0x3f];
+            }
+        }
+
+        /* Stops at the first group with a character outside of the alphabet. */
+        static inline void decodeScalar(const unsigned char *&p, const unsigned char *end, unsigned char *&q,
+                                        const signed char *aTable) {
+            for (; end - p >= 4; p += 4, q += 3) {
+                int a = aTable[p[0]], b = aTable[p[1]], c = aTable[p[2]], d = aTable[p[3]];
+                if ((a | b | c | d) < 0)
+                    return;
+                uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+                q[0] = (unsigned char)(v >> 16);
+                q[1] = (unsigned char)(v >> 8);
+                q[2] = (unsigned char)v;
+            }
+        }
+
+        static void decodeScalar(const unsigned char *&p, const unsigned char *end, unsigned char *&q) {
+            decodeScalar(p, end, q, gDecode);
+        }
+
+        static void decodeScalarURLSafe(const unsigned char *&p, const unsigned char *end, unsigned char *&q) {
+            decodeScalar(p, end, q, gDecodeURLSafe);
+        }
+
+#if defined(QTC_CPU_DISPATCH)
+        /*
+        ** SSSE3, 12 bytes / 16 characters at a time
+        */
+        QTC_TARGET_SSSE3
+        static inline __m128i encodeIndices(__m128i aInput) {
+            // Bytes [b a c b] of each group, then the four 6-bit fields into separate bytes.
+            __m128i v = _mm_shuffle_epi8(aInput, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                                                  7, 6, 8, 7, 10, 9, 11, 10));
+            __m128i ac = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                                         _mm_set1_epi32(0x04000040));
+            __m128i bd = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                                         _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(ac, bd);
+        }
+
+        QTC_TARGET_SSSE3
+        static inline __m128i encodeCharacters(__m128i aIndices) {
+            // 0..25 -> 13, 26..51 -> 0, 52..63 -> 1..12; then add the offset of that range.
+            const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            __m128i range = _mm_subs_epu8(aIndices, _mm_set1_epi8(51));
+            __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), aIndices);
+            range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+            return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), aIndices);
+        }
+
+        QTC_TARGET_SSSE3
+        static void encodeSSSE3(const unsigned char *&p, const unsigned char *end, char *&q) {
+            // Loads 16 bytes to use 12 of them.
+            for (; end - p >= 16; p += 12, q += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                _mm_storeu_si128((__m128i *)q, encodeCharacters(encodeIndices(v)));
+            }
+            encodeScalar(p, end, q);
+        }
+
+        /* Character values of 16 characters, false if any is outside of the alphabet. */
+        QTC_TARGET_SSSE3
+        static inline bool decodeValues(__m128i &aValues) {
+            const __m128i lowBits = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                  0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m128i highBits = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i offsets = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                                  0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i slash = _mm_set1_epi8(0x2f);
+
+            __m128i high = _mm_and_si128(_mm_srli_epi32(aValues, 4), slash);
+            __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lowBits, _mm_and_si128(aValues, slash)),
+                                            _mm_shuffle_epi8(highBits, high));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xffff)
+                return false;
+            // '/' shares its high nibble with '+'.
+            __m128i offset = _mm_shuffle_epi8(offsets, _mm_add_epi8(_mm_cmpeq_epi8(aValues, slash), high));
+            aValues = _mm_add_epi8(aValues, offset);
+            return true;
+        }
+
+        /* Packs 16 6-bit values into 12 bytes at the bottom of the register. */
+        QTC_TARGET_SSSE3
+        static inline __m128i decodePack(__m128i aValues) {
+            __m128i pairs = _mm_maddubs_epi16(aValues, _mm_set1_epi32(0x01400140));
+            __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            return _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                          -1, -1, -1, -1));
+        }
+
+        static inline void store12(unsigned char *q, __m128i aBytes) {
+            _mm_storel_epi64((__m128i *)q, aBytes);
+            uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(aBytes, 8));
+            memcpy(q + 8, &last, 4);
+        }
+
+        QTC_TARGET_SSSE3
+        static void decodeSSSE3(const unsigned char *&p, const unsigned char *end, unsigned char *&q) {
+            for (; end - p >= 16; p += 16, q += 12) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                if (!decodeValues(v))
+                    break;
+                store12(q, decodePack(v));
+            }
+            decodeScalar(p, end, q);
+        }
+
+        /*
+        ** AVX2, 24 bytes / 32 characters at a time
+        */
+        QTC_TARGET_AVX2
+        static void encodeAVX2(const unsigned char *&p, const unsigned char *end, char *&q) {
+            const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                     1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                     'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                     '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+            // The upper lane loads from p + 12, so 28 bytes must be readable.
+            for (; end - p >= 28; p += 24, q += 32) {
+                __m256i v = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p)),
+                    _mm_loadu_si128((const __m128i *)(p + 12)), 1);
+                v = _mm256_shuffle_epi8(v, shuffle);
+                __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                                _mm256_set1_epi32(0x04000040));
+                __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                                _mm256_set1_epi32(0x01000010));
+                __m256i indices = _mm256_or_si256(ac, bd);
+
+                __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+                __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+                _mm256_storeu_si256((__m256i *)q, chars);
+            }
+            encodeSSSE3(p, end, q);
+        }
+
+        QTC_TARGET_AVX2
+        static void decodeAVX2(const unsigned char *&p, const unsigned char *end, unsigned char *&q) {
+            const __m256i lowBits = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                     0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                                     0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                                     0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m256i highBits = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i offsets = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                                     0, 0, 0, 0, 0, 0, 0, 0,
+                                                     0, 16, 19, 4, -65, -65, -71, -71,
+                                                     0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+            const __m256i slash = _mm256_set1_epi8(0x2f);
+
+            for (; end - p >= 32; p += 32, q += 24) {
+                __m256i v = _mm256_loadu_si256((const __m256i *)p);
+                __m256i high = _mm256_and_si256(_mm256_srli_epi32(v, 4), slash);
+                __m256i invalid = _mm256_and_si256(_mm256_shuffle_epi8(lowBits, _mm256_and_si256(v, slash)),
+                                                   _mm256_shuffle_epi8(highBits, high));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(invalid, _mm256_setzero_si256())) != -1)
+                    break;
+                v = _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets,
+                                                           _mm256_add_epi8(_mm256_cmpeq_epi8(v, slash), high)));
+                __m256i pairs = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+                __m256i groups = _mm256_shuffle_epi8(_mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000)),
+                                                     pack);
+                store12(q, _mm256_castsi256_si128(groups));
+                store12(q + 12, _mm256_extracti128_si256(groups, 1));
+            }
+            decodeSSSE3(p, end, q);
+        }
+#endif /* QTC_CPU_DISPATCH */
+
+        struct Kernels {
+            EncodeKernel encode;
+            DecodeKernel decode;
+        };
+
+        static Kernels selectKernels() {
+#if defined(QTC_CPU_DISPATCH)
+            if (CPU::hasAVX2()) {
+                Kernels k = { encodeAVX2, decodeAVX2 };
+                return k;
+            }
+            if (CPU::hasSSSE3()) {
+                Kernels k = { encodeSSSE3, decodeSSSE3 };
+                return k;
+            }
+#endif
+            Kernels k = { encodeScalar, decodeScalar };
+            return k;
+        }
+
+        static const Kernels& kernels() {
+            static const Kernels k = selectKernels();
+            return k;
+        }
+
+        /* Decodes from aInput, continuing the group in aBits/aCount. Bytes
+           are written as soon as they are complete, like the old Decoder. */
+        static size_t decodeCharacters(const char *aInput, size_t aLength, char *aOutput,
+                                       Alphabet aAlphabet, uint32_t &aBits, int &aCount) {
+            const unsigned char *p = (const unsigned char *)aInput;
+            const unsigned char *end = p + aLength;
+            unsigned char *q = (unsigned char *)aOutput;
+            const signed char *table = aAlphabet == URLSafe ? gDecodeURLSafe : gDecode;
+            DecodeKernel kernel = aAlphabet == URLSafe ? decodeScalarURLSafe : kernels().decode;
+            uint32_t bits = aBits;
+            int count = aCount;
+
+            for (;;) {
+                // Whole groups go through the kernel, the rest one character at a time.
+                if (count == 0)
+                    kernel(p, end, q);
+                if (p == end)
+                    break;
+                int value = table[*p++];
+                if (value < 0)
+                    continue;
+                bits = bits << 6 | value;
+                switch (++count) {
+                case 2: *q++ = (unsigned char)(bits >> 4); break;
+                case 3: *q++ = (unsigned char)(bits >> 2); break;
+                case 4: *q++ = (unsigned char)bits; bits = 0; count = 0; break;
+                }
+            }
+            aBits = bits;
+            aCount = count;
+            return (char *)q - aOutput;
+        }
+
+        /* Whole groups only, aLength is a multiple of 3. */
+        static size_t encodeGroups(const char *aInput, size_t aLength, char *aOutput, Alphabet aAlphabet) {
+            const unsigned char *p = (const unsigned char *)aInput;
+            const unsigned char *end = p + aLength;
+            char *q = aOutput;
+
+            kernels().encode(p, end, q);
+            if (aAlphabet == URLSafe) {
+                for (char *c = aOutput; c != q; ++c)
+                    *c = *c == '+' ? '-' : (*c == '/' ? '_' : *c);
+            }
+            return q - aOutput;
+        }
+
+        /* The last 1 or 2 bytes, with padding. */
+        static size_t encodeFinal(const unsigned char *p, size_t aLength, char *q, const Options &aOptions) {
+            const char *alphabet = aOptions.alphabet == URLSafe ? gAlphabetURLSafe : gAlphabet;
+            size_t length = aLength + 1;
+
+            q[0] = alphabet[p[0] >> 2];
+            if (aLength == 1) {
+                q[1] = alphabet[(p[0] & 0x03) << 4];
+            } else {
+                q[1] = alphabet[(p[0] & 0x03) << 4 | p[1] >> 4];
+                q[2] = alphabet[(p[1] & 0x0f) << 2];
+            }
+            if (aOptions.padding) {
+                for (; length < 4; ++length)
+                    q[length] = '=';
+            }
+            return length;
+        }
+
+        /*
+        ** Span API
+        */
+        size_t encode(const char *aInput, size_t aLength, char *aOutput) {
+            size_t whole = aLength / 3 * 3;
+            size_t length = encodeGroups(aInput, whole, aOutput, Standard);
+
+            if (whole < aLength)
+                length += encodeFinal((const unsigned char *)aInput + whole, aLength - whole,
+                                      aOutput + length, Options());
+            return length;
+        }
+
+        size_t decode(const char *aInput, size_t aLength, char *aOutput) {
+            uint32_t bits = 0;
+            int count = 0;
+            return decodeCharacters(aInput, aLength, aOutput, Standard, bits, count);
+        }
+
+        /*
+        ** Encoder
+        */
+        Encoder::Encoder()
+            : iOptions(Standard, CHARS_PER_LINE, "\n"), iLineBreakLength(1),
+              iColumn(0), iPendingLength(0)
+        {
+        }
+
+        Encoder::Encoder(const Options &aOptions)
+            : iOptions(aOptions), iLineBreakLength(0), iColumn(0), iPendingLength(0)
+        {
+            if (iOptions.lineLength) {
+                iOptions.lineLength = iOptions.lineLength < 4 ? 4 : iOptions.lineLength / 4 * 4;
+                iLineBreakLength = strlen(iOptions.lineBreak);
+            }
+        }
+
+        size_t Encoder::maxLength(size_t aLength) const {
+            size_t length = encodedLength(iPendingLength + aLength);
+            if (iOptions.lineLength)
+                length += (iColumn + length) / iOptions.lineLength * iLineBreakLength;
+            return length;
+        }
+
+        char *Encoder::encodeGroups(const char *aInput, size_t aLength, char *aOutput) {
+            if (iOptions.lineLength == 0)
+                return aOutput + Base64::encodeGroups(aInput, aLength, aOutput, iOptions.alphabet);
+
+            while (aLength > 0) {
+                size_t room = (iOptions.lineLength - iColumn) / 4 * 3;
+                size_t length = room < aLength ? room : aLength;
+                size_t written = Base64::encodeGroups(aInput, length, aOutput, iOptions.alphabet);
+
+                aInput += length;
+                aLength -= length;
+                aOutput += written;
+                iColumn += written;
+                if (iColumn == iOptions.lineLength) {
+                    memcpy(aOutput, iOptions.lineBreak, iLineBreakLength);
+                    aOutput += iLineBreakLength;
+                    iColumn = 0;
+                }
+            }
+            return aOutput;
+        }
+
+        size_t Encoder::encodeBlock(const char *aInput, size_t aInputLength, char *aOutput) {
+            const char *input = aInput;
+            const char *end = aInput + aInputLength;
+            char *output = aOutput;
+
+            // Complete a group left over from the previous block first.
+            if (iPendingLength > 0) {
+                while (iPendingLength < 3 && input != end)
+                    iPending[iPendingLength++] = *input++;
+                if (iPendingLength < 3)
+                    return 0;
+                output = encodeGroups(iPending, 3, output);
+                iPendingLength = 0;
+            }
+
+            size_t whole = (end - input) / 3 * 3;
+            output = encodeGroups(input, whole, output);
+            for (input += whole; input != end; ++input)
+                iPending[iPendingLength++] = *input;
+            return output - aOutput;
+        }
+
+        size_t Encoder::encodeBlockEnd(char *aOutput) {
+            size_t length = 0;
+
+            if (iPendingLength > 0)
+                length = encodeFinal((const unsigned char *)iPending, iPendingLength, aOutput, iOptions);
+            iPendingLength = 0;
+            iColumn = 0;
+            return length;
+        }
+
+        /*
+        ** Decoder
+        */
+        Decoder::Decoder(Alphabet aAlphabet)
+            : iAlphabet(aAlphabet), iBits(0), iCount(0)
+        {
+        }
+
+        size_t Decoder::decodeBlock(const char *aInput, size_t aInputLength, char *aOutput) {
+            return decodeCharacters(aInput, aInputLength, aOutput, iAlphabet, iBits, iCount);
+        }
+
+    } /* namespace Base64 */
+
+} /* namespace QtC */
@@ -0,0 +1,81 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/CPU.h
+** Comment:    Run time detection of instruction set extensions.
+*/
+
+#ifndef QTC_COMMON_CPU_H
+#define QTC_COMMON_CPU_H
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define QTC_CPU_X86 1
+#endif
+
+#if defined(QTC_CPU_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define QTC_CPU_SSE2 1
+#endif
+
+/* Functions using extensions beyond the compiler's baseline are marked
+   with QTC_TARGET_*, and only called after checking CPU::has*(). */
+#if defined(QTC_CPU_SSE2) && defined(__GNUC__)
+#define QTC_CPU_DISPATCH 1
+#define QTC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define QTC_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(QTC_CPU_SSE2) && defined(_MSC_VER)
+#define QTC_CPU_DISPATCH 1
+#define QTC_TARGET_SSSE3
+#define QTC_TARGET_AVX2
+#include <intrin.h>
+#endif
+
+namespace QtC {
+
+    /** Instruction set extensions of the running processor. */
+    class CPU {
+    public:
+        static bool hasSSSE3() {
+            static const bool result = detect(Feature_SSSE3);
+            return result;
+        }
+        static bool hasAVX2() {
+            static const bool result = detect(Feature_AVX2);
+            return result;
+        }
+    private:
+        enum Feature {
+            Feature_SSSE3,
+            Feature_AVX2
+        };
+
+        static bool detect(Feature aFeature) {
+#if defined(QTC_CPU_DISPATCH) && defined(__GNUC__)
+            __builtin_cpu_init();
+            switch (aFeature) {
+            case Feature_SSSE3: return __builtin_cpu_supports("ssse3") != 0;
+            case Feature_AVX2:  return __builtin_cpu_supports("avx2") != 0;
+            }
+            return false;
+#elif defined(QTC_CPU_DISPATCH) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            switch (aFeature) {
+            case Feature_SSSE3:
+                return (info[2] & (1 << 9)) != 0;
+            case Feature_AVX2: {
+                // The OS must also save the YMM state (OSXSAVE + XCR0).
+                if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+                    return false;
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+            }
+            }
+            return false;
+#else
+            (void)aFeature;
+            return false;
+#endif
+        }
+    };
+
+} /* namespace QtC */
+
+#endif /* QTC_COMMON_CPU_H */
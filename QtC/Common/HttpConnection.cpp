@@ -12,6 +12,9 @@
 #include <memory>
 #include <list>
 #include <deque>
+#include <algorithm>
+#include <vector>
+#include <cstring>
 
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
@@ -106,6 +109,53 @@ namespace QtC {
         return worker;
     }
     
+    /*
+    ** RecyclePool : released objects are kept, with their buffers, for reuse.
+    */
+    template <class T>
+    class RecyclePool {
+    public:
+        enum { MAX_FREE = 64 };
+    public:
+        std::shared_ptr<T> acquire() {
+            std::lock_guard<std::mutex> lock(iMutex);
+            if (iFree.empty())
+                return nullptr;
+            std::shared_ptr<T> object = std::move(iFree.back());
+            iFree.pop_back();
+            return object;
+        }
+
+        /* Takes aObject, it is kept only if nobody else refers to it. */
+        void release(std::shared_ptr<T> &aObject) {
+            std::shared_ptr<T> object = std::move(aObject);
+            if (!object || object.use_count() != 1)
+                return;
+            object->recycle();
+            std::lock_guard<std::mutex> lock(iMutex);
+            if (iFree.size() < MAX_FREE)
+                iFree.push_back(std::move(object));
+        }
+
+        /* Never destroyed, objects may be released while exiting. */
+        static RecyclePool& shared() {
+            static RecyclePool *pool = new RecyclePool();
+            return *pool;
+        }
+    private:
+        std::mutex iMutex;
+        std::vector< std::shared_ptr<T> > iFree;
+    };
+
+    /* Empties a recycled buffer, large ones are not worth keeping. */
+    static void recycleBuffer(std::string &aBuffer) {
+        if (aBuffer.capacity() > 65536) {
+            std::string().swap(aBuffer);
+        } else {
+            aBuffer.clear();
+        }
+    }
+
     /*
     ** HttpReply
     */  
@@ -117,23 +167,33 @@ namespace QtC {
     public:
         virtual int status();
         virtual const Headers& headers();
+        virtual StringRef header(const StringRef &aName) const;
+        virtual StringRef header(KnownHeader aHeader) const;
         virtual const std::string& body() const;
     public:
-        void setStatus(int aStatus);
-        void addHeader(const std::string &aName,
-                       const std::string &aValue);        
+        /* Parses the status line and headers in the first aLength bytes
+           of the header buffer, the headers then refer into it. */
+        void parseHeader(size_t aLength);
+        void recycle();
     public:
-        /* Direct access to body buffer */
+        /* Direct access to body and header buffers */
         std::string& directBody() { return iBody; }
+        std::string& headerBuffer() { return iHeaderData; }
+    private:
+        static int knownHeader(const StringRef &aName);
     private:
         int iStatus;
+        std::string iHeaderData;
         Headers iHeaders;
+        int iKnown[KnownHeaderCount];
         std::string iBody;
     };
 
     HttpReplyPrivate::HttpReplyPrivate() 
         : iStatus(0) 
     {
+        iHeaders.reserve(16);
+        std::fill(iKnown, iKnown + KnownHeaderCount, -1);
     }
 
     int HttpReplyPrivate::status() {
@@ -142,21 +202,104 @@ namespace QtC {
     const HttpReply::Headers& HttpReplyPrivate::headers() {
         return iHeaders;
     }
+    StringRef HttpReplyPrivate::header(const StringRef &aName) const {
+        int known = knownHeader(aName);
+        if (known >= 0) {
+            return header((KnownHeader)known);
+        }
+        Headers::const_iterator header;
+        for(header=iHeaders.begin();header!=iHeaders.end();++header) {
+            if ((*header).first.equalsIgnoreCase(aName)) {
+                return (*header).second;
+            }
+        }
+        return StringRef();
+    }
+    StringRef HttpReplyPrivate::header(KnownHeader aHeader) const {
+        int index = iKnown[aHeader];
+        return index < 0 ? StringRef() : iHeaders[index].second;
+    }
     const std::string& HttpReplyPrivate::body() const {
         return iBody;
     }
-    
-    void HttpReplyPrivate::setStatus(int aStatus) {
-        iStatus = aStatus;
+
+    void HttpReplyPrivate::recycle() {
+        iStatus = 0;
+        recycleBuffer(iHeaderData);
+        iHeaders.clear();
+        std::fill(iKnown, iKnown + KnownHeaderCount, -1);
+        recycleBuffer(iBody);
     }
-    void HttpReplyPrivate::addHeader(const std::string &aName,
-                                     const std::string &aValue)
-    {
-        iHeaders.push_back( Header(aName,aValue) );
+
+    int HttpReplyPrivate::knownHeader(const StringRef &aName) {
+        // The well-known names all differ in length.
+        static const char *names[] = {
+            0, 0, 0, 0, 0, 0, 0, 0,
+            "Location", 0, "Connection", 0, "Content-Type", 0, "Content-Length", 0,
+            "Content-Encoding", "Transfer-Encoding"
+        };
+        static const int headers[] = {
+            -1, -1, -1, -1, -1, -1, -1, -1,
+            HeaderLocation, -1, HeaderConnection, -1, HeaderContentType, -1, HeaderContentLength, -1,
+            HeaderContentEncoding, HeaderTransferEncoding
+        };
+        size_t length = aName.size();
+        if (length >= sizeof(names)/sizeof(names[0]) || !names[length]) {
+            return -1;
+        }
+        return aName.equalsIgnoreCase(StringRef(names[length], length)) ? headers[length] : -1;
+    }
+
+    void HttpReplyPrivate::parseHeader(size_t aLength) {
+        const char *p = iHeaderData.data();
+        const char *end = p + aLength;
+        bool statusLine = true;
+
+        iHeaders.clear();
+        std::fill(iKnown, iKnown + KnownHeaderCount, -1);
+
+        while (p < end) {
+            const char *eol = (const char *)memchr(p, '\n', end - p);
+            const char *next = eol ? eol + 1 : end;
+            if (!eol) {
+                eol = end;
+            }
+            if (eol > p && eol[-1] == '\r') {
+                --eol;
+            }
+
+            if (statusLine) {
+                // HTTP/1.1 200 OK
+                const char *code = (const char *)memchr(p, ' ', eol - p);
+                iStatus = 0;
+                for (code = code ? code + 1 : eol; code < eol && *code >= '0' && *code <= '9'; ++code) {
+                    iStatus = iStatus*10 + (*code - '0');
+                }
+                statusLine = false;
+            } else {
+                const char *colon = (const char *)memchr(p, ':', eol - p);
+                if (colon) {
+                    const char *value = colon + 1;
+                    const char *valueEnd = eol;
+                    while (value < valueEnd && (*value == ' ' || *value == '\t')) ++value;
+                    while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) --valueEnd;
+
+                    StringRef name(p, colon - p);
+                    int known = knownHeader(name);
+                    if (known >= 0 && iKnown[known] < 0) {
+                        iKnown[known] = (int)iHeaders.size();
+                    }
+                    iHeaders.push_back(Header(name, StringRef(value, valueEnd - value)));
+                }
+            }
+            p = next;
+        }
     }
     
     HttpReply::HttpReply() {}
 
+    HttpBodyConsumer::~HttpBodyConsumer() {}
+
     /*
     ** HttpFormData
     */
@@ -202,10 +345,12 @@ namespace QtC {
         public:
             ValueStream(std::shared_ptr<std::istream> &aInputStream,
                         const std::string &aFilename,
-                        const std::string &aContentType)
+                        const std::string &aContentType,
+                        TransferEncoding aTransferEncoding)
                 : iInputStream(aInputStream),
                   iFilename(aFilename),
-                  iContentType(aContentType)
+                  iContentType(aContentType),
+                  iTransferEncoding(aTransferEncoding)
             {}
         public:
             virtual void printOut(std::ostream &os,
@@ -224,11 +369,25 @@ namespace QtC {
                     os<< "Content-Type: " << iContentType << "\r\n";
                 }
 
-                os << "Content-Transfer-Encoding: " << "binary" << "\r\n"; // Optional ?
+                if (iTransferEncoding == TransferEncodingBase64) {
+                    os << "Content-Transfer-Encoding: " << "base64" << "\r\n";
+                } else {
+                    os << "Content-Transfer-Encoding: " << "binary" << "\r\n"; // Optional ?
+                }
 
                 os << "\r\n";
                 
-                if (iInputStream) {
+                if (iInputStream && iTransferEncoding == TransferEncodingBase64) {
+                    // MIME lines (RFC 2045), encoded chunk by chunk.
+                    Base64::Encoder encoder(Base64::Options(Base64::Standard, 76));
+                    char buffer[6144];
+                    char code[8448];
+                    while(*iInputStream) {
+                        iInputStream->read(buffer,sizeof(buffer));
+                        os.write(code,encoder.encodeBlock(buffer,iInputStream->gcount(),code));
+                    }
+                    os.write(code,encoder.encodeBlockEnd(code));
+                } else if (iInputStream) {
                     char buffer[8192];
                     while(*iInputStream) {
                         iInputStream->read(buffer,sizeof(buffer));
@@ -239,16 +398,19 @@ namespace QtC {
         public:
             static ValueStream::var get(std::shared_ptr<std::istream> &aInputStream,
                                         const std::string &aFilename,
-                                        const std::string &aContentType) 
+                                        const std::string &aContentType,
+                                        TransferEncoding aTransferEncoding) 
             {
                 return std::make_shared<ValueStream>(aInputStream,
                                                      aFilename,
-                                                     aContentType);
+                                                     aContentType,
+                                                     aTransferEncoding);
             }
         private:
             std::shared_ptr<std::istream> iInputStream;
             std::string iFilename;
             std::string iContentType;
+            TransferEncoding iTransferEncoding;
         };
     public:
         HttpFormDataPrivate();
@@ -259,7 +421,8 @@ namespace QtC {
         virtual void append(const std::string &aName,
                             std::shared_ptr<std::istream> aInputStream,
                             const std::string &aFilename = std::string(),
-                            const std::string &aContentType = std::string());
+                            const std::string &aContentType = std::string(),
+                            TransferEncoding aTransferEncoding = TransferEncodingBinary);
     public:
         void printOut(std::ostream &os) const;
     private:
@@ -294,11 +457,13 @@ namespace QtC {
     void HttpFormDataPrivate::append(const std::string &aName,
                                      std::shared_ptr<std::istream> aInputStream,
                                      const std::string &aFilename,
-                                     const std::string &aContentType)
+                                     const std::string &aContentType,
+                                     TransferEncoding aTransferEncoding)
     {
         iFields.push_back(Field(aName,ValueStream::get(aInputStream,
                                                        aFilename,
-                                                       aContentType)));
+                                                       aContentType,
+                                                       aTransferEncoding)));
     }
 
     void HttpFormDataPrivate::printOut(std::ostream &os) const {
@@ -316,42 +481,87 @@ namespace QtC {
         return std::make_shared<HttpFormDataPrivate>();
     }
     
+    /*
+    ** HttpHeaderBlock
+    */
+    HttpHeaderBlock& HttpHeaderBlock::add(const std::string &aName,
+                                          const std::string &aValue)
+    {
+        iData.append(aName).append(": ").append(aValue).append("\r\n");
+        return *this;
+    }
+
     /*
     ** HttpRequest
     */
     class HttpRequestPrivate : public HttpRequest {
     public:
+        typedef std::shared_ptr<HttpRequestPrivate> var;
         typedef std::pair<std::string, std::string> Header;
+        typedef std::vector< Header > Headers;
     public:
-        HttpRequestPrivate(Method aMethod,
-                           const URI::FullPath &aRequestPath);
-        
+        HttpRequestPrivate();
+
+        /* A recycled request if there is one */
+        static HttpRequestPrivate::var get(Method aMethod,
+                                           const StringRef &aRequestTarget);
+        void recycle();
     public:
         virtual void addHeader(const std::string &aName,
                                const std::string &aValue);
         virtual void removeHeader(const std::string &aName);
+        virtual void setCommonHeaders(HttpHeaderBlock::var aHeaders);
 
         virtual void setContentType(const std::string &aContentType);
         virtual void setContentLength(size_t aContentLength);
 
         virtual void setBody(const std::string &aBody);
+        virtual void setBody(std::string &&aBody);
         virtual void setBody(const JSON::Object &aValue);
         virtual void setBody(HttpFormData::var aFormData);
 
+        virtual void setBodyConsumer(HttpBodyConsumer::var aConsumer);
+        virtual HttpBodyConsumer::var bodyConsumer() const;
+
+        virtual Buffers buffers() const;
         virtual std::string toString() const;
     private:
         Method iMethod;
-        URI::FullPath iRequestPath;
-        std::list< Header > iHeaders;
+        std::string iRequestTarget;
+        HttpHeaderBlock::var iCommonHeaders;
+        Headers iHeaders;
+        mutable std::string iHead;
         
         std::string iBody;
         HttpFormDataPrivate::var iFormData;
+        HttpBodyConsumer::var iBodyConsumer;
     };
     
-    HttpRequestPrivate::HttpRequestPrivate(Method aMethod,
-                                           const URI::FullPath &aRequestPath)
-        : iMethod(aMethod), iRequestPath(aRequestPath)
+    HttpRequestPrivate::HttpRequestPrivate()
+        : iMethod(MethodGet)
+    {
+        iHeaders.reserve(8);
+    }
+
+    HttpRequestPrivate::var HttpRequestPrivate::get(Method aMethod,
+                                                    const StringRef &aRequestTarget)
     {
+        HttpRequestPrivate::var request = RecyclePool<HttpRequestPrivate>::shared().acquire();
+        if (!request) {
+            request = std::make_shared<HttpRequestPrivate>();
+        }
+        request->iMethod = aMethod;
+        request->iRequestTarget.assign(aRequestTarget.data(),aRequestTarget.size());
+        return request;
+    }
+
+    void HttpRequestPrivate::recycle() {
+        iCommonHeaders.reset();
+        iHeaders.clear();
+        iHead.clear();
+        recycleBuffer(iBody);
+        iFormData.reset();
+        iBodyConsumer.reset();
     }
     
     void HttpRequestPrivate::addHeader(const std::string &aName,
@@ -362,7 +572,7 @@ namespace QtC {
     }
     
     void HttpRequestPrivate::removeHeader(const std::string &aName) {
-        std::list< Header >::iterator header;
+        Headers::iterator header;
         for(header=iHeaders.begin();header!=iHeaders.end();) {
             if ((*header).first==aName) {
                 header=iHeaders.erase(header);
@@ -372,6 +582,10 @@ namespace QtC {
         }
     }
 
+    void HttpRequestPrivate::setCommonHeaders(HttpHeaderBlock::var aHeaders) {
+        iCommonHeaders = aHeaders;
+    }
+
     void HttpRequestPrivate::setContentType(const std::string &aContentType) {
         const std::string name="Content-Type";
         removeHeader(name);
@@ -386,15 +600,14 @@ namespace QtC {
     }
 
     void HttpRequestPrivate::setBody(const std::string &aBody) {
-        iBody = aBody;
+        setBody(std::string(aBody));
+    }
+    void HttpRequestPrivate::setBody(std::string &&aBody) {
+        iBody = std::move(aBody);
         
         // Todo support : chunked_transfer_encoding 
 
-        std::cout << iBody << "\n";
-        //exit(0);
-        
-
-        setContentLength(iBody.empty()?0:iBody.size());
+        setContentLength(iBody.size());
     }
     void HttpRequestPrivate::setBody(const JSON::Object &aValue) {
         setBody(aValue.toString());
@@ -417,37 +630,56 @@ namespace QtC {
         setBody(bodyStream.str());
     }
 
-    std::string HttpRequestPrivate::toString() const {
-        std::stringstream request;
-        
-        // Header
-        switch(iMethod) {
-        case MethodGet:    request << "GET ";    break;
-        case MethodPost:   request << "POST ";   break;
-        case MethodPut:    request << "PUT ";   break;
-        case MethodDelete: request << "DELETE "; break;
+    void HttpRequestPrivate::setBodyConsumer(HttpBodyConsumer::var aConsumer) {
+        iBodyConsumer = aConsumer;
+    }
+    HttpBodyConsumer::var HttpRequestPrivate::bodyConsumer() const {
+        return iBodyConsumer;
+    }
+
+    HttpRequest::Buffers HttpRequestPrivate::buffers() const {
+        size_t length = sizeof("DELETE  HTTP/1.1\r\n\r\n") + iRequestTarget.size();
+        if (iCommonHeaders) {
+            length += iCommonHeaders->data().size();
         }
-        request << iRequestPath << " HTTP/1.1\r\n";
-        
-        std::list< Header >::const_iterator header;
+        Headers::const_iterator header;
         for(header=iHeaders.begin();header!=iHeaders.end();++header) {
-            request << (*header).first << ": " << (*header).second << "\r\n";
+            length += (*header).first.size() + (*header).second.size() + 4;
         }
-        
-        request << "\r\n";
 
-        if (!iBody.empty()) {
-            request << iBody;
+        // Header, the body is sent from its own buffer.
+        iHead.clear();
+        iHead.reserve(length);
+        switch(iMethod) {
+        case MethodGet:    iHead.append("GET ");    break;
+        case MethodPost:   iHead.append("POST ");   break;
+        case MethodPut:    iHead.append("PUT ");    break;
+        case MethodDelete: iHead.append("DELETE "); break;
+        }
+        iHead.append(iRequestTarget).append(" HTTP/1.1\r\n");
+        if (iCommonHeaders) {
+            iHead.append(iCommonHeaders->data());
+        }
+        for(header=iHeaders.begin();header!=iHeaders.end();++header) {
+            iHead.append((*header).first).append(": ").append((*header).second).append("\r\n");
         }
+        iHead.append("\r\n");
 
-        return request.str();
+        Buffers buffers = {{ boost::asio::buffer(iHead), boost::asio::buffer(iBody) }};
+        return buffers;
+    }
+
+    std::string HttpRequestPrivate::toString() const {
+        buffers();
+        return iHead + iBody;
     }
     
     HttpRequest::HttpRequest() {}
     HttpRequest::var HttpRequest::get(Method aMethod,
                                       const URI::FullPath &aRequestPath) 
     {
-        return std::make_shared<HttpRequestPrivate>(aMethod,aRequestPath);
+        std::string target = aRequestPath.toString();
+        return HttpRequestPrivate::get(aMethod,target.empty() ? StringRef("/") : StringRef(target));
     }
     HttpRequest::var HttpRequest::getGet(const URI::FullPath &aRequestPath) {
         return get(MethodGet,aRequestPath);
@@ -461,6 +693,23 @@ namespace QtC {
     HttpRequest::var HttpRequest::getDelete(const URI::FullPath &aRequestPath) {
         return get(MethodDelete,aRequestPath);
     }
+    HttpRequest::var HttpRequest::get(Method aMethod,
+                                      const URIBuffer &aRequestURI)
+    {
+        return HttpRequestPrivate::get(aMethod,aRequestURI.target());
+    }
+    HttpRequest::var HttpRequest::getGet(const URIBuffer &aRequestURI) {
+        return get(MethodGet,aRequestURI);
+    }
+    HttpRequest::var HttpRequest::getPost(const URIBuffer &aRequestURI) {
+        return get(MethodPost,aRequestURI);
+    }
+    HttpRequest::var HttpRequest::getPut(const URIBuffer &aRequestURI) {
+        return get(MethodPut,aRequestURI);
+    }
+    HttpRequest::var HttpRequest::getDelete(const URIBuffer &aRequestURI) {
+        return get(MethodDelete,aRequestURI);
+    }
 
     /*
     ** HttpConnectionTask
@@ -469,11 +718,15 @@ namespace QtC {
     public:
         typedef std::shared_ptr<HttpConnectionTask> var;
     public:
-        HttpConnectionTask(HttpRequest::var aRequest,
-                           HttpRequest::Callback aCallback);
+        HttpConnectionTask();
+
+        /* A recycled task if there is one, the callback is moved in. */
+        static HttpConnectionTask::var get(HttpRequest::var aRequest,
+                                           HttpRequest::Callback aCallback);
+        void recycle();
         
         HttpRequest::var request() { return iRequest; }
-        HttpRequest::Callback callback() { return iCallback; }
+        HttpRequest::Callback& callback() { return iCallback; }
         HttpReplyPrivate::var reply() { return iReply; }
 
         void received(const char *aData, size_t aLength);
@@ -481,64 +734,111 @@ namespace QtC {
         void finalizeTask();
 
         inline bool taskCompleted() const { return iTaskCompleted; }
+    private:
+        void receivedBody(const char *aData, size_t aLength);
     private:
         HttpRequest::var iRequest;
         HttpRequest::Callback iCallback;
         HttpReplyPrivate::var iReply;
-        bool iStatusCompleted;
+        HttpBodyConsumer::var iBodyConsumer;
+        std::string iHeader;
+        size_t iHeaderScanned;
         bool iHeaderCompleted;
         bool iTaskCompleted;
         size_t iContentLength;
+        size_t iBodyLength;
     };
     
-    HttpConnectionTask::HttpConnectionTask(HttpRequest::var aRequest,
-                                           HttpRequest::Callback aCallback)
-        : iRequest(aRequest), iCallback(aCallback),
-          iReply(std::make_shared<HttpReplyPrivate>()),
-          iStatusCompleted(false),
+    HttpConnectionTask::HttpConnectionTask()
+        : iHeaderScanned(0),
           iHeaderCompleted(false),
           iTaskCompleted(false),
-          iContentLength(0)
+          iContentLength(0),
+          iBodyLength(0)
     {}
+
+    HttpConnectionTask::var HttpConnectionTask::get(HttpRequest::var aRequest,
+                                                    HttpRequest::Callback aCallback)
+    {
+        HttpConnectionTask::var task = RecyclePool<HttpConnectionTask>::shared().acquire();
+        if (!task) {
+            task = std::make_shared<HttpConnectionTask>();
+        }
+        task->iBodyConsumer = aRequest->bodyConsumer();
+        task->iRequest = std::move(aRequest);
+        task->iCallback = std::move(aCallback);
+        if (!task->iReply) {
+            task->iReply = std::make_shared<HttpReplyPrivate>();
+        }
+        return task;
+    }
+
+    void HttpConnectionTask::recycle() {
+        HttpRequestPrivate::var request = std::dynamic_pointer_cast<HttpRequestPrivate>(iRequest);
+        iRequest.reset();
+        RecyclePool<HttpRequestPrivate>::shared().release(request);
+
+        // The reply is kept unless the callback held on to it.
+        if (iReply.use_count() == 1) {
+            iReply->recycle();
+        } else {
+            iReply.reset();
+        }
+        iCallback = nullptr;
+        iBodyConsumer.reset();
+        recycleBuffer(iHeader);
+        iHeaderScanned = 0;
+        iHeaderCompleted = false;
+        iTaskCompleted = false;
+        iContentLength = 0;
+        iBodyLength = 0;
+    }
     
     void HttpConnectionTask::received(const char *aData, size_t aLength) {
-        size_t r;
-        
-        std::string &body = iReply->directBody();
-        body.append(aData,aLength);
-        
-        while(!iHeaderCompleted) {
-            r=body.find("\r\n");
-            if (r==std::string::npos) 
-                break;
-            
-            std::string row = body.substr(0,r);
-            body.erase(0,r+2);
-            
-            if (row.empty()) {
-                iHeaderCompleted = true;
-            } else if (iStatusCompleted) {
-                r=row.find(": ");
-                if (r!=std::string::npos) {
-                    std::string name=row.substr(0,r);
-                    std::string value=row.substr(r+2);
-                    
-                    iReply->addHeader(name,value);
-
-                    if (name=="Content-Length") {
-                        iContentLength=atoi(value.c_str());
-                    }
-                }
-            } else {
-                r=row.find(" ");
-                if (r!=std::string::npos) {
-                    iReply->setStatus(atoi(row.substr(r+1).c_str()));
-                }
-                iStatusCompleted = true;
-            }
+        if (iHeaderCompleted) {
+            receivedBody(aData,aLength);
+            return;
+        }
+
+        iHeader.append(aData,aLength);
+
+        // The empty row may straddle the previous block.
+        size_t end = iHeader.find("\r\n\r\n", iHeaderScanned);
+        if (end == std::string::npos) {
+            iHeaderScanned = iHeader.size() < 3 ? 0 : iHeader.size() - 3;
+            return;
+        }
+        iHeaderCompleted = true;
+
+        /* The reply keeps the header buffer, its headers refer into it. */
+        std::string &header = iReply->headerBuffer();
+        header.swap(iHeader);
+        iReply->parseHeader(end + 2);
+
+        StringRef contentLength = iReply->header(HttpReply::HeaderContentLength);
+        for (const char *c = contentLength.begin(); c != contentLength.end() && *c >= '0' && *c <= '9'; ++c) {
+            iContentLength = iContentLength*10 + (*c - '0');
+        }
+
+        if (!iBodyConsumer && iContentLength) {
+            iReply->directBody().reserve(iContentLength);
+        }
+
+        /* Rest of the buffer is body. */
+        receivedBody(header.data()+end+4,header.length()-end-4);
+    }
+
+    void HttpConnectionTask::receivedBody(const char *aData, size_t aLength) {
+        iBodyLength += aLength;
+
+        if (iBodyConsumer) {
+            if (aLength)
+                iBodyConsumer->consume(aData,aLength);
+        } else {
+            iReply->directBody().append(aData,aLength);
         }
         
-        if (iContentLength != 0 && body.length() == iContentLength) {
+        if (iContentLength != 0 && iBodyLength == iContentLength) {
             finalizeTask();
         }
     }
@@ -625,7 +925,7 @@ namespace QtC {
                                       HttpRequest::Callback aCallback)
     {
         std::lock_guard<std::mutex> lock(iMutex);
-        iTasks.push_back( std::make_shared<HttpConnectionTask>(aRequest,aCallback) );
+        iTasks.push_back( HttpConnectionTask::get(std::move(aRequest),std::move(aCallback)) );
         
         if (iActiveTask) {
             return;
@@ -635,8 +935,9 @@ namespace QtC {
     }
 
     void HttpConnectionPrivate::process_next_task_L() {
+        RecyclePool<HttpConnectionTask>::shared().release(iActiveTask);
+
         if (iTasks.empty()) {
-            iActiveTask = nullptr;
             return;
         } else {
             iActiveTask = iTasks.front();
@@ -678,11 +979,14 @@ namespace QtC {
             return;
         }
         
+        // The request owns the buffers, keep it alive until the write completes.
+        HttpRequest::var request = iActiveTask->request();
         boost::asio::async_write(iSocket, 
-                                 boost::asio::buffer(iActiveTask->request()->toString()),
-                                 boost::bind(&HttpConnectionPrivate::handle_write, this, 
-                                             boost::asio::placeholders::error, 
-                                             boost::asio::placeholders::bytes_transferred));
+                                 request->buffers(),
+                                 [this, request](const boost::system::error_code& error,
+                                                 size_t bytes_transferred) {
+                                     handle_write(error, bytes_transferred);
+                                 });
     }
     
     void HttpConnectionPrivate::active_task_failed(const boost::system::error_code& error) {
@@ -807,7 +1111,7 @@ namespace QtC {
                                       HttpRequest::Callback aCallback)
     {
         std::lock_guard<std::mutex> lock(iMutex);
-        iTasks.push_back( std::make_shared<HttpConnectionTask>(aRequest,aCallback) );
+        iTasks.push_back( HttpConnectionTask::get(std::move(aRequest),std::move(aCallback)) );
         
         if (iActiveTask) {
             return;
@@ -817,8 +1121,9 @@ namespace QtC {
     }
 
     void HttpsConnectionPrivate::process_next_task_L() {
+        RecyclePool<HttpConnectionTask>::shared().release(iActiveTask);
+
         if (iTasks.empty()) {
-            iActiveTask = nullptr;
             return;
         } else {
             iActiveTask = iTasks.front();
@@ -865,11 +1170,14 @@ namespace QtC {
             return;
         }
         
+        // The request owns the buffers, keep it alive until the write completes.
+        HttpRequest::var request = iActiveTask->request();
         boost::asio::async_write(iSocket, 
-                                 boost::asio::buffer(iActiveTask->request()->toString()),
-                                 boost::bind(&HttpsConnectionPrivate::handle_write, this, 
-                                             boost::asio::placeholders::error, 
-                                             boost::asio::placeholders::bytes_transferred));
+                                 request->buffers(),
+                                 [this, request](const boost::system::error_code& error,
+                                                 size_t bytes_transferred) {
+                                     handle_write(error, bytes_transferred);
+                                 });
     }
     
     void HttpsConnectionPrivate::active_task_failed(const boost::system::error_code& error) {
@@ -13,9 +13,13 @@
 #include <memory>
 #include <functional>
 #include <list>
+#include <vector>
+#include <array>
 
 #include <boost/system/error_code.hpp>
+#include <boost/asio/buffer.hpp>
 
+#include <QtC/Common/StringRef.h>
 #include <QtC/Common/URI.h>
 #include <QtC/Common/JSON.h>
 
@@ -24,19 +28,50 @@ namespace QtC {
     class HttpReply {
     public:
         typedef std::shared_ptr<HttpReply> var;
-        typedef std::pair<std::string, std::string> Header;
-        typedef std::list< Header > Headers;
+        /* Views into the reply's header buffer, valid as long as the reply. */
+        typedef std::pair<StringRef, StringRef> Header;
+        typedef std::vector< Header > Headers;
+        /* Headers indexed while parsing, looked up without a scan. */
+        enum KnownHeader {
+            HeaderConnection,
+            HeaderContentEncoding,
+            HeaderContentLength,
+            HeaderContentType,
+            HeaderLocation,
+            HeaderTransferEncoding,
+            KnownHeaderCount
+        };
     protected:
         HttpReply();
     public:
         virtual int status() = 0;
         virtual const Headers& headers() = 0;
+        /* First header of that name, case-insensitively; empty if none. */
+        virtual StringRef header(const StringRef &aName) const = 0;
+        virtual StringRef header(KnownHeader aHeader) const = 0;
         virtual const std::string& body() const = 0;        
     };
 
+    /*
+    ** Receives the reply body as it arrives. A request with a body
+    ** consumer does not collect the body into HttpReply::body().
+    */
+    class HttpBodyConsumer {
+    public:
+        typedef std::shared_ptr<HttpBodyConsumer> var;
+    public:
+        virtual ~HttpBodyConsumer();
+
+        virtual void consume(const char *aData, size_t aLength) = 0;
+    };
+
     class HttpFormData {
     public:
         typedef std::shared_ptr<HttpFormData> var;
+        enum TransferEncoding {
+            TransferEncodingBinary,
+            TransferEncodingBase64
+        };
     protected:
         HttpFormData();
     public:
@@ -47,12 +82,29 @@ namespace QtC {
         virtual void append(const std::string &aName,
                             std::shared_ptr<std::istream> aInputStream,
                             const std::string &aFilename = std::string(),
-                            const std::string &aContentType = std::string()) = 0;
+                            const std::string &aContentType = std::string(),
+                            TransferEncoding aTransferEncoding = TransferEncodingBinary) = 0;
     public:
         /* Global getter */
         static HttpFormData::var get();
     };
     
+    /*
+    ** Headers serialized once and shared by many requests, such as the
+    ** ones every request to a backend carries.
+    */
+    class HttpHeaderBlock {
+    public:
+        typedef std::shared_ptr<const HttpHeaderBlock> var;
+    public:
+        HttpHeaderBlock& add(const std::string &aName,
+                             const std::string &aValue);
+
+        const std::string& data() const { return iData; }
+    private:
+        std::string iData;
+    };
+
     class HttpRequest {
     public:
         typedef std::shared_ptr<HttpRequest> var;
@@ -71,14 +123,25 @@ namespace QtC {
         virtual void addHeader(const std::string &aName,
                                const std::string &aValue) = 0;
         virtual void removeHeader(const std::string &aName) = 0;
+        /* Sent before the request's own headers, which must not repeat them. */
+        virtual void setCommonHeaders(HttpHeaderBlock::var aHeaders) = 0;
 
         virtual void setContentType(const std::string &aContentType) = 0;
         virtual void setContentLength(size_t aContentLength) = 0;
         
         virtual void setBody(const std::string &aBody) = 0;
+        virtual void setBody(std::string &&aBody) = 0;
         virtual void setBody(const JSON::Object &aValue) = 0;
         virtual void setBody(HttpFormData::var aFormData) = 0;
+
+        virtual void setBodyConsumer(HttpBodyConsumer::var aConsumer) = 0;
+        virtual HttpBodyConsumer::var bodyConsumer() const = 0;
         
+        /* Request line and headers, then the body, for a gather write.
+           The buffers stay valid until the request is modified. */
+        typedef std::array<boost::asio::const_buffer, 2> Buffers;
+        virtual Buffers buffers() const = 0;
+
         virtual std::string toString() const = 0;
     public:
         /* Global getter */
@@ -90,6 +153,14 @@ namespace QtC {
         static HttpRequest::var getPost(const URI::FullPath &aRequestPath);
         static HttpRequest::var getPut(const URI::FullPath &aRequestPath);
         static HttpRequest::var getDelete(const URI::FullPath &aRequestPath);
+
+        /* Same for a prebuilt URI, only its request target is used */
+        static HttpRequest::var get(Method aMethod,
+                                    const URIBuffer &aRequestURI);
+        static HttpRequest::var getGet(const URIBuffer &aRequestURI);
+        static HttpRequest::var getPost(const URIBuffer &aRequestURI);
+        static HttpRequest::var getPut(const URIBuffer &aRequestURI);
+        static HttpRequest::var getDelete(const URIBuffer &aRequestURI);
     };
     
     class HttpConnection {
@@ -2,7 +2,8 @@
 ** File:       QtC/Common/JSON.cpp
 */
 
-#include <sstream>
+#include <climits>
+#include <cstring>
 #include <stdexcept>
 
 #include "QtC/Common/JSON.h"
@@ -15,15 +16,18 @@ namespace QtC {
         
         Value::Value() : type_t(NIL) { }
         
-        Value::Value(const long long int i) : int_v(i), type_t(INT) { }
+        Value::Value(const long long int i) : int_v(i), unsigned_v(false), type_t(INT) { }
         
-        Value::Value(const long int i) : int_v(static_cast<long long int>(i)), type_t(INT) { }
+        Value::Value(const long int i) : int_v(static_cast<long long int>(i)), unsigned_v(false), type_t(INT) { }
         
-        Value::Value(const int i) : int_v(static_cast<int>(i)), type_t(INT) { }
+        Value::Value(const int i) : int_v(static_cast<int>(i)), unsigned_v(false), type_t(INT) { }
         
-        Value::Value(const long double f) : float_v(f), type_t(FLOAT) { }
+        Value::Value(const unsigned long long int u)
+            : int_v(static_cast<long long int>(u)), unsigned_v(u > static_cast<unsigned long long int>(LLONG_MAX)), type_t(INT) { }
         
-        Value::Value(const double f) : float_v(static_cast<long double>(f)), type_t(FLOAT) { }
+        Value::Value(const long double f) : float_v(static_cast<double>(f)), type_t(FLOAT) { }
+        
+        Value::Value(const double f) : float_v(f), type_t(FLOAT) { }
         
         Value::Value(const bool b) : bool_v(b), type_t(BOOL) { }
         
@@ -48,6 +52,7 @@ namespace QtC {
                     /** Base types */
                 case INT:
                     int_v = v.int_v;
+                    unsigned_v = v.unsigned_v;
                     type_t = INT;
                     break;
                     
@@ -91,6 +96,7 @@ namespace QtC {
                     /** Base types */
                 case INT:
                     int_v = move(v.int_v);
+                    unsigned_v = v.unsigned_v;
                     type_t = INT;
                     break;
                     
@@ -134,6 +140,7 @@ namespace QtC {
                     /** Base types */
                 case INT:
                     int_v = v.int_v;
+                    unsigned_v = v.unsigned_v;
                     type_t = INT;
                     break;
                     
@@ -180,6 +187,7 @@ namespace QtC {
                     /** Base types */
                 case INT:
                     int_v = move(v.int_v);
+                    unsigned_v = v.unsigned_v;
                     type_t = INT;
                     break;
                     
@@ -248,6 +256,68 @@ namespace QtC {
         }
         
 
+        static const std::shared_ptr<const std::string>& emptyKey() {
+            static const std::shared_ptr<const std::string> empty = std::make_shared<const std::string>();
+            return empty;
+        }
+
+        Key::Key() : iString(emptyKey()) { }
+
+        Key::Key(const char *aString) : iString(std::make_shared<const std::string>(aString)) { }
+
+        Key::Key(const std::string &aString) : iString(std::make_shared<const std::string>(aString)) { }
+
+        Key::Key(std::string &&aString) : iString(std::make_shared<const std::string>(move(aString))) { }
+
+        bool Key::operator==(const Key &aOther) const {
+            return iString == aOther.iString || *iString == *aOther.iString;
+        }
+
+        bool Key::operator<(const Key &aOther) const {
+            return iString != aOther.iString && *iString < *aOther.iString;
+        }
+
+        Key Key::borrow(const std::string &aString) {
+            Key key;
+            // Aliasing constructor with an empty owner: no allocation, no ownership.
+            key.iString = std::shared_ptr<const std::string>(std::shared_ptr<const std::string>(), &aString);
+            return key;
+        }
+
+        size_t KeyTable::KeyHash::operator()(const Key &aKey) const {
+            return std::hash<std::string>()(aKey.str());
+        }
+
+        KeyTable::KeyTable(size_t aCapacity)
+            : iCapacity(aCapacity)
+        {
+        }
+
+        Key KeyTable::intern(const std::string &aString) {
+            std::unordered_set<Key, KeyHash>::const_iterator i = iKeys.find(Key::borrow(aString));
+            if (i != iKeys.end())
+                return *i;
+
+            Key key(aString);
+            if (iKeys.size() < iCapacity)
+                iKeys.insert(key);
+            return key;
+        }
+
+        Key KeyTable::intern(const char *aData, size_t aLength) {
+            // Keeps its capacity, a known key costs no allocation.
+            iScratch.assign(aData, aLength);
+            return intern(iScratch);
+        }
+
+        size_t KeyTable::size() const {
+            return iKeys.size();
+        }
+
+        void KeyTable::clear() {
+            iKeys.clear();
+        }
+
         String::String() {
         }
         String::String(const String &aOther)
@@ -301,238 +371,468 @@ namespace QtC {
         }
         
 
-        Object::Object() { }
+        /*
+        ** Object, the container is shared between copies until one of
+        ** them is modified. No container is allocated while empty. A
+        ** container with mutable references outside is never shared.
+        */
+        const Object::Container& Object::container() const
+        {
+            static const Container empty;
+            return _object ? *_object : empty;
+        }
+
+        Object::Container& Object::mutate()
+        {
+            _hash.store(0, memory_order_relaxed);
+            if (!_object)
+                _object = make_shared<Container>();
+            else if (_object.use_count() > 1)
+                _object = make_shared<Container>(*_object);
+            return *_object;
+        }
+
+        Object::Container& Object::detach()
+        {
+            Container &object = mutate();
+            _unsharable = true;
+            return object;
+        }
+
+        Object::Object() : _unsharable(false), _hash(0) { }
         
         Object::~Object() { }
         
-        Object::Object(const Object& o) : _object(o._object) { }
+        Object::Object(const Object& o)
+            : _object(o._unsharable ? make_shared<Container>(*o._object) : o._object),
+              _unsharable(false), _hash(o._hash.load(memory_order_relaxed)) { }
         
-        Object::Object(Object&& o) : _object(move(o._object)) { }
+        Object::Object(Object&& o)
+            : _object(move(o._object)), _unsharable(o._unsharable),
+              _hash(o._hash.exchange(0, memory_order_relaxed)) {
+            o._unsharable = false;
+        }
         
-        Object::Object(std::initializer_list<Association> aArgs) {
+        Object::Object(std::initializer_list<Association> aArgs) : _unsharable(false), _hash(0) {
             std::initializer_list<Association>::iterator i;
             for(i=aArgs.begin();i!=aArgs.end();++i) {
-                insert(std::pair<string,Value> ( (*i).name(), (*i).value() ));
+                mutate().insert(Container::value_type( Key((*i).name()), (*i).value() ));
             }
         }
             
         Object& Object::operator=(const Object& o)
         {
-            _object = o._object;
+            if (this == &o)
+                return *this;
+            _object = o._unsharable ? make_shared<Container>(*o._object) : o._object;
+            _unsharable = false;
+            _hash.store(o._hash.load(memory_order_relaxed), memory_order_relaxed);
             return *this;
         }
         
         Object& Object::operator=(Object&& o)
         {
+            if (this == &o)
+                return *this;
             _object = move(o._object);
+            _unsharable = o._unsharable;
+            o._unsharable = false;
+            _hash.store(o._hash.exchange(0, memory_order_relaxed), memory_order_relaxed);
             return *this;
         }
         
         Value& Object::operator[] (const string& key)
         {
-            return _object[key];
+            Container &object = detach();
+            iterator i = object.find(Key::borrow(key));
+            if (i != object.end())
+                return i->second;
+            // Borrowed key must not be stored, insert an owning one.
+            return object.insert(Container::value_type(Key(key), Value())).first->second;
         }
         
         const Value& Object::operator[] (const string& key) const
         {
-            return _object.at(key);
+            return container().at(Key::borrow(key));
         }
         
-        pair<map<string, Value>::iterator, bool> Object::insert(const pair<string, Value>& v)
+        Object::const_iterator Object::find(const string& key) const
+        {
+            return container().find(Key::borrow(key));
+        }
+
+        Object::iterator Object::find(const string& key)
+        {
+            return detach().find(Key::borrow(key));
+        }
+
+        pair<Object::iterator, bool> Object::insert(const pair<string, Value>& v)
         {
-            return _object.insert(v);
+            return detach().insert(Container::value_type(Key(v.first), v.second));
         }
 
         void Object::insert(const String &aString, const Value &aValue) {
-            insert(pair<string, Value>(aString.str(),aValue));
+            mutate().insert(Container::value_type(Key(aString.str()), aValue));
+        }
+
+        pair<Object::iterator, bool> Object::insert(const Key &aKey, Value &&aValue)
+        {
+            return detach().insert(Container::value_type(aKey, move(aValue)));
+        }
+
+        bool Object::add(const Key &aKey, Value &&aValue)
+        {
+            return mutate().insert(Container::value_type(aKey, move(aValue))).second;
         }
         
-        map<string, Value>::const_iterator Object::begin() const
+        size_t Object::erase(const string& key)
+        {
+            if (!_object)
+                return 0;
+            return mutate().erase(Key::borrow(key));
+        }
+
+        Object::const_iterator Object::begin() const
         {
-            return _object.begin();
+            return container().begin();
         }
         
-        map<string, Value>::const_iterator Object::end() const
+        Object::const_iterator Object::end() const
         {
-            return _object.end();
+            return container().end();
         }
         
-        map<string, Value>::iterator Object::begin()
+        Object::iterator Object::begin()
         {
-            return _object.begin();
+            return detach().begin();
         }
         
-        map<string, Value>::iterator Object::end()
+        Object::iterator Object::end()
         {
-            return _object.end();
+            return detach().end();
         }
         
         size_t Object::size() const
         {
-            return _object.size();
+            return container().size();
+        }
+
+        bool Object::shared() const
+        {
+            return _object && _object.use_count() > 1;
         }
 
         std::string Object::toString() const {
-            std::ostringstream stream;
-            stream << *this;
-            return stream.str();
+            Writer writer;
+            writer.write(*this);
+            return writer.str();
         }
         
-        Array::Array() { }
+        /*
+        ** Array, shared like Object.
+        */
+        const Array::Container& Array::container() const
+        {
+            static const Container empty;
+            return _array ? *_array : empty;
+        }
+
+        Array::Container& Array::mutate()
+        {
+            _hash.store(0, memory_order_relaxed);
+            if (!_array)
+                _array = make_shared<Container>();
+            else if (_array.use_count() > 1)
+                _array = make_shared<Container>(*_array);
+            return *_array;
+        }
+
+        Array::Container& Array::detach()
+        {
+            Container &array = mutate();
+            _unsharable = true;
+            return array;
+        }
+
+        Array::Array() : _unsharable(false), _hash(0) { }
         
         Array::~Array() { }
         
-        Array::Array(const Array& a) : _array(a._array) { }
+        Array::Array(const Array& a)
+            : _array(a._unsharable ? make_shared<Container>(*a._array) : a._array),
+              _unsharable(false), _hash(a._hash.load(memory_order_relaxed)) { }
         
-        Array::Array(Array&& a) : _array(move(a._array)) { }
+        Array::Array(Array&& a)
+            : _array(move(a._array)), _unsharable(a._unsharable),
+              _hash(a._hash.exchange(0, memory_order_relaxed)) {
+            a._unsharable = false;
+        }
         
-        Array::Array(std::initializer_list<Value> aArgs) {
-            std::initializer_list<Value>::iterator i;
-            for(i=aArgs.begin();i!=aArgs.end();++i) {
-                push_back(*i);
-            }
+        Array::Array(std::initializer_list<Value> aArgs) : _unsharable(false), _hash(0) {
+            mutate().assign(aArgs.begin(), aArgs.end());
         }
 
         Array& Array::operator=(const Array& a)
         {
-            _array = a._array;
+            if (this == &a)
+                return *this;
+            _array = a._unsharable ? make_shared<Container>(*a._array) : a._array;
+            _unsharable = false;
+            _hash.store(a._hash.load(memory_order_relaxed), memory_order_relaxed);
             return *this;
         }
         
         Array& Array::operator=(Array&& a)
         {
+            if (this == &a)
+                return *this;
             _array = move(a._array);
+            _unsharable = a._unsharable;
+            a._unsharable = false;
+            _hash.store(a._hash.exchange(0, memory_order_relaxed), memory_order_relaxed);
             return *this;
         }
         
         
         Value& Array::operator[] (size_t i)
         {
-            return _array.at(i);
+            return detach().at(i);
         }
         
         const Value& Array::operator[] (size_t i) const
         {
-            return _array.at(i);
+            return container().at(i);
         }
         
         vector<Value>::const_iterator Array::begin() const
         {
-            return _array.begin();
+            return container().begin();
         }
         
         vector<Value>::const_iterator Array::end() const
         {
-            return _array.end();
+            return container().end();
         }
         
         vector<Value>::iterator Array::begin()
         {
-            return _array.begin();
+            return detach().begin();
         }
         
         vector<Value>::iterator Array::end()
         {
-            return _array.end();
+            return detach().end();
         }
         
         size_t Array::size() const
         {
-            return _array.size();
+            return container().size();
         }
         
+        bool Array::shared() const
+        {
+            return _array && _array.use_count() > 1;
+        }
+
         void Array::push_back(const Value& v)
         {
-            _array.push_back(v);
+            mutate().push_back(v);
         }
-        
-        void indent(ostream& os) {
-            for (unsigned int i  = 0; i < ind; i++)
-                os << "\t";
+
+        void Array::push_back(Value&& v)
+        {
+            mutate().push_back(move(v));
+        }
+
+        /*
+        ** Equality and hashing
+        */
+        static const unsigned long long int gHashSeed = 0x9e3779b97f4a7c15ULL;
+
+        /* splitmix64 finalizer */
+        static inline unsigned long long int mix(unsigned long long int aValue) {
+            aValue ^= aValue >> 30;
+            aValue *= 0xbf58476d1ce4e5b9ULL;
+            aValue ^= aValue >> 27;
+            aValue *= 0x94d049bb133111ebULL;
+            return aValue ^ (aValue >> 31);
+        }
+
+        static inline unsigned long long int combine(unsigned long long int aSeed, unsigned long long int aValue) {
+            return mix(aSeed + gHashSeed + aValue);
         }
-                
+
+        /* FNV-1a */
+        static unsigned long long int hashBytes(const std::string &aString) {
+            unsigned long long int hash = 0xcbf29ce484222325ULL;
+            for (size_t n = 0; n < aString.size(); ++n) {
+                hash ^= (unsigned char)aString[n];
+                hash *= 0x100000001b3ULL;
+            }
+            return hash;
+        }
+
+        bool Value::operator==(const Value &v) const
+        {
+            if (type_t != v.type_t)
+                return false;
+            switch(type_t)
+                {
+                case INT:    return int_v == v.int_v && unsigned_v == v.unsigned_v;
+                case FLOAT:  return float_v == v.float_v;
+                case BOOL:   return bool_v == v.bool_v;
+                case NIL:    return true;
+                case STRING: return string_v == v.string_v;
+                case ARRAY:  return array_v == v.array_v;
+                case OBJECT: return object_v == v.object_v;
+                }
+            return false;
+        }
+
+        unsigned long long int Value::hash() const
+        {
+            bool stable = true;
+            return hash(stable);
+        }
+
+        unsigned long long int Value::hash(bool &aStable) const
+        {
+            switch(type_t)
+                {
+                case INT:    return combine(INT + unsigned_v, (unsigned long long int)int_v);
+                case FLOAT: {
+                    // 0.0 == -0.0, so both must hash the same.
+                    double f = (float_v == 0) ? 0.0 : float_v;
+                    unsigned long long int bits;
+                    memcpy(&bits, &f, sizeof(bits));
+                    return combine(FLOAT, bits);
+                }
+                case BOOL:   return combine(BOOL, bool_v);
+                case NIL:    return combine(NIL, 0);
+                case STRING: return combine(STRING, hashBytes(string_v));
+                case ARRAY:  return array_v.hash(aStable);
+                case OBJECT: return object_v.hash(aStable);
+                }
+            return 0;
+        }
+
+        /* A cached hash is only kept while no mutable reference into
+           the subtree has escaped: any later write must then go through
+           this object's non-const members, which clear the cache. So a
+           cached hash is never stale and may reject unequal trees. */
+        bool Object::operator==(const Object &o) const
+        {
+            if (this == &o || _object == o._object)
+                return true;
+            unsigned long long int left = _hash.load(memory_order_relaxed);
+            unsigned long long int right = o._hash.load(memory_order_relaxed);
+            if (size() != o.size() || (left && right && left != right))
+                return false;
+            // Both maps are ordered by key, so they are walked together.
+            for (const_iterator i = begin(), j = o.begin(); i != end(); ++i, ++j) {
+                if (i->first != j->first || i->second != j->second)
+                    return false;
+            }
+            return true;
+        }
+
+        unsigned long long int Object::hash() const
+        {
+            bool stable = true;
+            return hash(stable);
+        }
+
+        unsigned long long int Object::hash(bool &aStable) const
+        {
+            unsigned long long int cached = _hash.load(memory_order_relaxed);
+            if (cached == 0) {
+                bool stable = !_unsharable;
+                unsigned long long int hash = combine(OBJECT, size());
+                for (const_iterator i = begin(); i != end(); ++i)
+                    hash = combine(combine(hash, hashBytes(i->first.str())), i->second.hash(stable));
+                cached = hash ? hash : 1;
+                if (stable)
+                    _hash.store(cached, memory_order_relaxed);
+                else
+                    aStable = false;
+            }
+            return cached;
+        }
+
+        bool Array::operator==(const Array &a) const
+        {
+            if (this == &a || _array == a._array)
+                return true;
+            unsigned long long int leftHash = _hash.load(memory_order_relaxed);
+            unsigned long long int rightHash = a._hash.load(memory_order_relaxed);
+            const Container &left = container();
+            const Container &right = a.container();
+            if (left.size() != right.size() || (leftHash && rightHash && leftHash != rightHash))
+                return false;
+            for (size_t n = 0; n < left.size(); ++n) {
+                if (left[n] != right[n])
+                    return false;
+            }
+            return true;
+        }
+
+        unsigned long long int Array::hash() const
+        {
+            bool stable = true;
+            return hash(stable);
+        }
+
+        unsigned long long int Array::hash(bool &aStable) const
+        {
+            unsigned long long int cached = _hash.load(memory_order_relaxed);
+            if (cached == 0) {
+                bool stable = !_unsharable;
+                const Container &array = container();
+                unsigned long long int hash = combine(ARRAY, array.size());
+                for (size_t n = 0; n < array.size(); ++n)
+                    hash = combine(hash, array[n].hash(stable));
+                cached = hash ? hash : 1;
+                if (stable)
+                    _hash.store(cached, memory_order_relaxed);
+                else
+                    aStable = false;
+            }
+            return cached;
+        }
+        
     } /* namespace JSON */
 
 } /* namespace QtC */
 
 
+ostream& operator<<(ostream& os, const QtC::JSON::Key& k) {
+    return os << k.str();
+}
+
 ostream& operator<<(ostream& os, const QtC::JSON::Value& v) {
-    using namespace QtC::JSON;
-    
-    switch(v.type()) {
-        /** Base types */
-    case INT:
-        os << (long long int)v;
-        break;
-        
-    case FLOAT:
-        os << (long double)v;
-        break;
-        
-    case BOOL:
-        os << ((bool)v ? "true" : "false");
-        break;
-        
-    case NIL:
-        os << "null";
-        break;
-        
-    case STRING:
-        os << '"' << (string)v << '"';                
-        break;
-        
-        /** Compound types */
-    case ARRAY:
-        os << (Array)v;                
-        break;
-        
-    case OBJECT:
-        os << (Object)v;                
-        break;
-        
-    }
-    return os;
+    QtC::JSON::Writer writer(QtC::JSON::Writer::Pretty);
+    writer.write(v);
+    return os << writer.str();
 }
 
 ostream& operator<<(ostream& os, const QtC::JSON::Association &a) {
-    os << '"' << a.name() << '"' << ": " << a.value();
-    return os;
+    QtC::JSON::Writer writer(QtC::JSON::Writer::Pretty);
+    writer.string(a.name());
+    writer.buffer().append(": ", 2);
+    writer.write(a.value());
+    return os << writer.str();
 }
 
 ostream& operator<<(ostream& os, const QtC::JSON::Object& o) {
-    os << "{" << endl;
-    QtC::JSON::ind++;
-    for (auto e = o.begin(); e != o.end();)
-        {
-            QtC::JSON::indent(os);
-            os << '"' << e->first << '"' << ": " << e->second;
-            if (++e != o.end())
-                os << ",";
-            os << endl;
-        }    
-    QtC::JSON::ind--;
-    QtC::JSON::indent(os);
-    os << "}";
-    
-    return os;
+    QtC::JSON::Writer writer(QtC::JSON::Writer::Pretty);
+    writer.write(o);
+    return os << writer.str();
 }
 
 ostream& operator<<(ostream& os, const QtC::JSON::Array& a) {
-    os << "[" << endl;
-    QtC::JSON::ind++;
-    for (auto e = a.begin(); e != a.end();)
-        {
-            QtC::JSON::indent(os);
-            os << (*e);
-            if (++e != a.end())
-                os << ",";
-            os << endl;
-        }    
-    QtC::JSON::ind--;
-    QtC::JSON::indent(os);
-    os << "]";
-    
-    return os;
+    QtC::JSON::Writer writer(QtC::JSON::Writer::Pretty);
+    writer.write(a);
+    return os << writer.str();
 }
 
 QtC::JSON::Association operator|(const QtC::JSON::String &a, const QtC::JSON::Object &b) {
@@ -5,10 +5,16 @@
 #ifndef QTC_COMMON_JSON_H
 #define QTC_COMMON_JSON_H
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <vector>
 #include <stack>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include <QtC/Common/StringRef.h>
 
 namespace QtC {
     
@@ -28,6 +34,58 @@ namespace QtC {
         // Forward declaration
         class Value;
 
+        /** An object key. Keys handed out by the same KeyTable share their
+            storage, so equal keys of a parsed document (e.g. "id" in every
+            record of a find result) are stored only once and compare equal
+            by pointer. */
+        class Key {
+        public:
+            Key();
+            explicit Key(const char *aString);
+            explicit Key(const std::string &aString);
+            explicit Key(std::string &&aString);
+
+            const std::string& str() const { return *iString; }
+            operator const std::string&() const { return *iString; }
+
+            /** True if both keys share the same (interned) storage. */
+            bool sameAs(const Key &aOther) const { return iString == aOther.iString; }
+
+            bool operator==(const Key &aOther) const;
+            bool operator!=(const Key &aOther) const { return !(*this == aOther); }
+            bool operator<(const Key &aOther) const;
+
+            /** Non-owning key for lookups; must not outlive aString. */
+            static Key borrow(const std::string &aString);
+        private:
+            friend class KeyTable;
+            std::shared_ptr<const std::string> iString;
+        };
+
+        /** Interning table for object keys. One table can be used for a
+            single document or shared by all replies of a collection.
+            @remark not thread-safe.
+        */
+        class KeyTable {
+        public:
+            /** @param aCapacity maximum number of distinct keys kept, keys
+                beyond this are returned without interning. */
+            KeyTable(size_t aCapacity = 4096);
+
+            Key intern(const std::string &aString);
+            Key intern(const char *aData, size_t aLength);
+
+            size_t size() const;
+            void clear();
+        private:
+            struct KeyHash {
+                size_t operator()(const Key &aKey) const;
+            };
+            size_t iCapacity;
+            std::unordered_set<Key, KeyHash> iKeys;
+            std::string iScratch;       // lookup buffer, reused between keys
+        };
+
         class String {
         public:
             String();
@@ -56,8 +114,18 @@ namespace QtC {
         
         /** A JSON object, i.e., a container whose keys are strings, this
             is roughly equivalent to a Python dictionary, a PHP's associative
-            array, a Perl or a C++ map (depending on the implementation). */
+            array, a Perl or a C++ map (depending on the implementation).
+            Copies share the members (copy-on-write): copying is O(1), and
+            the first non-const access of a shared object copies it.
+            Once a mutable reference or iterator has been handed out, by
+            the non-const operator[], find(), begin(), end() or insert(),
+            the object is unsharable: later copies copy the members, so
+            writes through that reference never reach a copy. */
         class Object {
+        public:
+            typedef std::map<Key, Value> Container;
+            typedef Container::iterator iterator;
+            typedef Container::const_iterator const_iterator;
         public:
             /** Constructor. */
             Object();
@@ -100,41 +168,91 @@ namespace QtC {
             /** Retrieves the starting iterator (const).
                 @remark mainly for printing
             */
-            std::map<std::string, Value>::const_iterator begin() const;
+            const_iterator begin() const;
             
             /** Retrieves the ending iterator (const).
                 @remark mainly for printing
             */
-            std::map<std::string, Value>::const_iterator end() const;
+            const_iterator end() const;
             
             /** Retrieves the starting iterator */
-            std::map<std::string, Value>::iterator begin();
+            iterator begin();
             
             /** Retrieves the ending iterator */
-            std::map<std::string, Value>::iterator end();
+            iterator end();
             
+            /** Finds a field by key, end() if not present. */
+            const_iterator find(const std::string& key) const;
+            iterator find(const std::string& key);
+
             /** Inserts a field in the object.
                 @param v pair <key, value> to insert
                 @return an iterator to the inserted object
             */
-            std::pair<std::map<std::string, Value>::iterator, bool> insert(const std::pair<std::string, Value>& v);
+            std::pair<iterator, bool> insert(const std::pair<std::string, Value>& v);
 
             void insert(const String &aString, const Value &aValue);
+
+            /** Inserts a field with an (interned) key. */
+            std::pair<iterator, bool> insert(const Key &aKey, Value &&aValue);
+
+            /** Inserts a field unless present, without handing out an
+                iterator, so the object stays sharable. */
+            bool add(const Key &aKey, Value &&aValue);
+
+            /** Removes a field, returns the number removed (0 or 1). */
+            size_t erase(const std::string &key);
             
             /** Size of the object. */
             size_t size() const;
 
             std::string toString() const;
+
+            /** Structural equality, stops at the first difference. */
+            bool operator==(const Object &o) const;
+            bool operator!=(const Object &o) const { return !(*this == o); }
+
+            /** Stable 64 bit hash, cached until the object is next
+                accessed through a non-const member. Not cached while a
+                mutable reference into the object may be held outside. */
+            unsigned long long int hash() const;
+
+            /** True if the members are shared with a copy. */
+            bool shared() const;
+        protected:
+            friend class Value;
+
+            /** hash(), aStable is cleared unless the hash could be cached. */
+            unsigned long long int hash(bool &aStable) const;
+
+            const Container& container() const;
+
+            /** Container for modification, unshared first. */
+            Container& mutate();
+
+            /** mutate() for a reference or iterator that escapes. */
+            Container& detach();
         protected:
             
-            /** Inner container. */
-            std::map<std::string, Value> _object;
+            /** Inner container, nullptr while empty. */
+            std::shared_ptr<Container> _object;
+
+            /** A mutable reference into _object may be held outside. */
+            bool _unsharable;
+
+            /** Cached hash, 0 when not computed. Atomic since const
+                access to a shared container may come from many threads. */
+            mutable std::atomic<unsigned long long int> _hash;
         };
         
         /** A JSON array, i.e., an indexed container of elements. It contains
-            JSON values, that can have any of the types in ValueType. */
+            JSON values, that can have any of the types in ValueType.
+            Copy-on-write and unsharable like Object, through the non-const
+            operator[], begin() and end(). */
         class Array
         {
+        public:
+            typedef std::vector<Value> Container;
         public:
             
             /** Constructor. */
@@ -195,14 +313,42 @@ namespace QtC {
                 @param n (a pointer to) the value to add
             */
             void push_back(const Value& n);
+            void push_back(Value&& n);
             
             /** Size of the array. */
             size_t size() const;
             
+            /** Structural equality, stops at the first difference. */
+            bool operator==(const Array &a) const;
+            bool operator!=(const Array &a) const { return !(*this == a); }
+
+            /** Stable 64 bit hash, cached like Object::hash(). */
+            unsigned long long int hash() const;
+
+            /** True if the elements are shared with a copy. */
+            bool shared() const;
+        protected:
+            friend class Value;
+
+            unsigned long long int hash(bool &aStable) const;
+
+            const Container& container() const;
+
+            /** Container for modification, unshared first. */
+            Container& mutate();
+
+            /** mutate() for a reference or iterator that escapes. */
+            Container& detach();
         protected:
             
-            /** Inner container. */
-            std::vector<Value> _array;
+            /** Inner container, nullptr while empty. */
+            std::shared_ptr<Container> _array;
+
+            /** A mutable reference into _array may be held outside. */
+            bool _unsharable;
+
+            /** Cached hash, 0 when not computed. */
+            mutable std::atomic<unsigned long long int> _hash;
             
         };
         
@@ -225,7 +371,10 @@ namespace QtC {
             /** Constructor from int. */
             Value(const int i);
             
-            /** Constructor from float. */
+            /** Constructor from unsigned int, keeps the full 64 bit range. */
+            Value(const unsigned long long int u);
+            
+            /** Constructor from float (stored as double). */
             Value(const long double f);
             
             /** Constructor from float. */
@@ -290,8 +439,15 @@ namespace QtC {
             /** Move operator. */
             Value& operator=(Value&& v);
             
+            /** Structural equality; INT and FLOAT values never compare equal. */
+            bool operator==(const Value &v) const;
+            bool operator!=(const Value &v) const { return !(*this == v); }
+
+            /** Stable 64 bit hash, equal values hash equally. */
+            unsigned long long int hash() const;
+            
             /** Cast operator for float */
-            explicit operator long double() const { return float_v; }
+            explicit operator double() const { return float_v; }
             
             /** Cast operator for int */
             explicit operator long long int() const { return int_v; }
@@ -309,22 +465,40 @@ namespace QtC {
             operator Array () const { return array_v; }
             
             /** Cast operator for float */
-            long double as_float() const { return float_v; }
+            double as_float() const { return float_v; }
             
             /** Cast operator for int */
             long long int as_int() const { return int_v; }
             
+            /** Cast operator for unsigned int */
+            unsigned long long int as_uint() const { return (unsigned long long int)int_v; }
+            
+            /** True for an INT beyond the long long range, read it with as_uint(). */
+            bool is_unsigned() const { return type_t == INT && unsigned_v; }
+            
             /** Cast operator for bool */
             bool as_bool() const { return bool_v; }
             
             /** Cast operator for string */
             std::string as_string() const { return string_v; }
             
+            /** Accessors by reference (no copy) */
+            const std::string& string_ref() const { return string_v; }
+            const Object& object_ref() const { return object_v; }
+            const Array& array_ref() const { return array_v; }
+            Object& object_ref() { return object_v; }
+            Array& array_ref() { return array_v; }
             
         protected:
+            friend class Object;
+            friend class Array;
+
+            unsigned long long int hash(bool &aStable) const;
             
-            long double         float_v;
+            
+            double              float_v;
             long long int       int_v;
+            bool                unsigned_v;
             bool                bool_v;
             std::string         string_v;
             
@@ -334,20 +508,441 @@ namespace QtC {
             ValueType           type_t;
         };
         
-        /** Indentation counter */
-        static unsigned int ind;
-        
-        /** Print correct indentation before printing anything */
-        static void indent(std::ostream& os = std::cout);
+        /** JSON text writer. Appends to an internal buffer which keeps its
+            capacity over clear(), so one writer can serialize many
+            documents without reallocating. Output is compact by default.
+        */
+        class Writer {
+        public:
+            enum Format {
+                Compact,    // no whitespace at all
+                Pretty      // one member per line, tab indentation
+            };
+        public:
+            Writer(Format aFormat = Compact);
+
+            /** Empties the buffer, capacity is retained. */
+            void clear();
+
+            const std::string& str() const { return iBuffer; }
+            std::string& buffer() { return iBuffer; }
+
+            /** Writes a complete value. */
+            Writer& write(const Value &aValue);
+            Writer& write(const Object &aObject);
+            Writer& write(const Array &aArray);
+
+            /* Event interface, separators are inserted automatically. */
+            Writer& beginObject();
+            Writer& endObject();
+            Writer& beginArray();
+            Writer& endArray();
+            Writer& key(const char *aData, size_t aLength);
+            Writer& key(const std::string &aKey) { return key(aKey.data(), aKey.size()); }
+            Writer& null();
+            Writer& boolean(bool aValue);
+            Writer& integer(long long int aValue);
+            Writer& unsignedInteger(unsigned long long int aValue);
+            Writer& number(double aValue);
+            Writer& string(const char *aData, size_t aLength);
+            Writer& string(const std::string &aString) { return string(aString.data(), aString.size()); }
+        private:
+            void separator();
+            void newline();
+            void close(char aBracket);
+        private:
+            Format iFormat;
+            std::string iBuffer;
+            std::vector<bool> iFirst;   // per open container: no member written yet
+            bool iAfterKey;
+        };
         
+        /** Receiver of Reader events. Every callback returns true to
+            continue or false to stop parsing. String data passed to
+            string() and key() is only valid during the call.
+        */
+        class Handler {
+        public:
+            virtual ~Handler();
+
+            virtual bool null();
+            virtual bool boolean(bool aValue);
+            virtual bool integer(long long int aValue);
+            /** Integers above the long long range, passed to number() by default. */
+            virtual bool unsignedInteger(unsigned long long int aValue);
+            virtual bool number(double aValue);
+            virtual bool string(const char *aData, size_t aLength);
+            /** Binary data (CBOR byte strings), passed to string() by default. */
+            virtual bool bytes(const char *aData, size_t aLength);
+
+            virtual bool beginObject();
+            virtual bool key(const char *aData, size_t aLength);
+            virtual bool endObject();
+
+            virtual bool beginArray();
+            virtual bool endArray();
+        };
+
+        /** Event based (SAX style) JSON reader. Reports the document to a
+            Handler without building a Value tree. The document can be
+            given at once with parse(), or in arbitrary chunks with feed()
+            as it arrives, followed by finish().
+        */
+        class Reader {
+        public:
+            enum Status {
+                Complete,       // document parsed
+                Incomplete,     // more input needed (feed)
+                Aborted,        // handler returned false
+                SyntaxError     // malformed input, see errorOffset()
+            };
+        public:
+            Reader();
+
+            Status parse(const char *aData, size_t aLength, Handler &aHandler);
+            Status parse(const std::string &aText, Handler &aHandler);
+
+            /** Incremental parsing: reset(), feed() any number of chunks,
+                finish(). A token split between chunks is carried over. */
+            void reset();
+            Status feed(const char *aData, size_t aLength, Handler &aHandler);
+            Status finish(Handler &aHandler);
+
+            /** Input offset of the last syntax error. */
+            size_t errorOffset() const { return iErrorOffset; }
+        private:
+            enum State {
+                StateValue,             // value expected
+                StateArrayFirst,        // value or ']' expected
+                StateArrayNext,         // ',' or ']' expected
+                StateObjectFirst,       // key or '}' expected
+                StateObjectKey,         // key expected
+                StateObjectColon,       // ':' expected
+                StateObjectNext,        // ',' or '}' expected
+                StateDone
+            };
+            const char *value(const char *p, const char *end, Handler &aHandler);
+            const char *string(const char *p, const char *end, Handler &aHandler, bool aKey);
+            const char *number(const char *p, const char *end, Handler &aHandler);
+            const char *literal(const char *p, const char *end, Handler &aHandler);
+            const char *endValue(const char *p);
+            const char *fail(const char *p);
+            const char *more(const char *p);
+            Status run(const char *aData, size_t aLength, Handler &aHandler);
+        private:
+            const char *iBegin;
+            const char *iIncomplete;    // start of a token cut by the chunk end
+            bool iFinal;                // no more input after this chunk
+            size_t iOffset;             // stream offset of iBegin
+            std::string iPending;       // carried over partial token
+            size_t iResume;             // bytes of a cut string token already scanned, 0 if none
+            bool iResumeEscaped;        // the scanned part has escapes
+            size_t iResumeNonASCII;     // offset of its first byte >= 0x80, 0 if none
+            State iState;
+            std::vector<char> iStack;   // '{' or '[' per open container
+            std::string iScratch;       // unescaped string data
+            Status iStatus;
+            size_t iErrorOffset;
+        };
+
+        /** CBOR (RFC 8949) encoder, the binary counterpart of Writer.
+            Values are encoded losslessly; containers opened without a
+            size are written with indefinite length, so a stream can be
+            encoded without knowing its size up front.
+        */
+        class CBORWriter {
+        public:
+            CBORWriter();
+
+            /** Empties the buffer, capacity is retained. */
+            void clear();
+
+            const std::string& str() const { return iBuffer; }
+            std::string& buffer() { return iBuffer; }
+
+            CBORWriter& write(const Value &aValue);
+            CBORWriter& write(const Object &aObject);
+            CBORWriter& write(const Array &aArray);
+
+            /* Event interface */
+            CBORWriter& beginObject();
+            CBORWriter& beginObject(size_t aSize);
+            CBORWriter& endObject();
+            CBORWriter& beginArray();
+            CBORWriter& beginArray(size_t aSize);
+            CBORWriter& endArray();
+            CBORWriter& key(const char *aData, size_t aLength) { return string(aData, aLength); }
+            CBORWriter& key(const std::string &aKey) { return string(aKey.data(), aKey.size()); }
+            CBORWriter& null();
+            CBORWriter& boolean(bool aValue);
+            CBORWriter& integer(long long int aValue);
+            CBORWriter& unsignedInteger(unsigned long long int aValue);
+            CBORWriter& number(double aValue);
+            CBORWriter& string(const char *aData, size_t aLength);
+            CBORWriter& string(const std::string &aString) { return string(aString.data(), aString.size()); }
+            CBORWriter& bytes(const char *aData, size_t aLength);
+        private:
+            void head(unsigned int aMajor, unsigned long long int aArgument);
+            void close();
+        private:
+            std::string iBuffer;
+            std::vector<bool> iIndefinite;  // per open container
+        };
+
+        /** CBOR decoder reporting to a Handler like Reader does. Definite
+            length strings are passed without copying; map keys must be
+            text strings.
+            @remark not incremental: parse() takes a complete encoding,
+            there is no feed()/finish() like Reader has. Only the
+            CBORWriter streams.
+        */
+        class CBORReader {
+        public:
+            CBORReader();
+
+            Reader::Status parse(const char *aData, size_t aLength, Handler &aHandler);
+            Reader::Status parse(const std::string &aData, Handler &aHandler);
+
+            /** Input offset of the last error. */
+            size_t errorOffset() const { return iErrorOffset; }
+        private:
+            struct Frame {
+                unsigned long long int remaining;   // items, or pairs for maps
+                bool indefinite;
+                bool map;
+                bool key;                           // a map key is next
+            };
+            const char *item(const char *p, const char *end, Handler &aHandler);
+            const char *chunks(const char *p, const char *end, unsigned int aMajor, Handler &aHandler, bool aKey);
+            bool done(Handler &aHandler);
+            const char *fail(const char *p);
+        private:
+            const char *iBegin;
+            std::vector<Frame> iStack;
+            std::string iScratch;       // indefinite length strings
+            bool iComplete;
+            bool iError;
+            size_t iErrorOffset;
+        };
+
+        /** Handler building a Value tree, object keys are interned. */
+        class ValueBuilder : public Handler {
+        public:
+            ValueBuilder();
+            ValueBuilder(KeyTable &aKeys);
+
+            void reset();
+
+            /** The parsed document (after Reader::Complete). */
+            Value& value() { return iValue; }
+
+            virtual bool null();
+            virtual bool boolean(bool aValue);
+            virtual bool integer(long long int aValue);
+            virtual bool unsignedInteger(unsigned long long int aValue);
+            virtual bool number(double aValue);
+            virtual bool string(const char *aData, size_t aLength);
+            virtual bool beginObject();
+            virtual bool key(const char *aData, size_t aLength);
+            virtual bool endObject();
+            virtual bool beginArray();
+            virtual bool endArray();
+        private:
+            bool add(Value &&aValue);
+
+            struct Frame {
+                bool isObject;
+                Object object;
+                Array array;
+                Key key;
+            };
+        private:
+            KeyTable iOwnKeys;
+            KeyTable *iKeys;
+            std::vector<Frame> iStack;
+            size_t iDepth;              // used frames in iStack
+            Value iValue;
+        };
+
+        /** Lazily parsed document. parse() validates the text and builds
+            a compact structural index (tape) in a single pass; values are
+            only decoded when a Node is read. Unescaped strings are
+            referenced in the source buffer, which is borrowed and kept
+            alive through the owner given to parse().
+            @remark buffers are limited to 4 GiB.
+        */
+        class Document {
+        public:
+            class Node;
+
+            /** Iterates the members of an object or the elements of an array. */
+            class iterator {
+            public:
+                iterator() : iDocument(nullptr), iIndex(0), iObject(false) { }
+
+                /** Member name (objects only). */
+                Node key() const;
+                Node value() const;
+                Node operator*() const { return value(); }
+
+                iterator& operator++();
+                bool operator==(const iterator &aOther) const { return iIndex == aOther.iIndex; }
+                bool operator!=(const iterator &aOther) const { return iIndex != aOther.iIndex; }
+            private:
+                friend class Node;
+                iterator(const struct DocumentPrivate *aDocument, size_t aIndex, bool aObject)
+                    : iDocument(aDocument), iIndex(aIndex), iObject(aObject) { }
+
+                const struct DocumentPrivate *iDocument;
+                size_t iIndex;
+                bool iObject;
+            };
+
+            /** A value in the document, valid while the Document is. A
+                missing member or index gives an invalid node, reading an
+                invalid node or a node of another type gives a default. */
+            class Node {
+            public:
+                Node() : iDocument(nullptr), iIndex(0) { }
+
+                bool valid() const { return iDocument != nullptr; }
+                ValueType type() const;
+
+                /** Number of members / elements, 0 for scalars. */
+                size_t size() const;
+
+                Node operator[](const std::string &aKey) const;
+                Node operator[](size_t aIndex) const;
+
+                iterator begin() const;
+                iterator end() const;
+
+                long long int asInt() const;
+                unsigned long long int asUInt() const;
+                double asFloat() const;
+                bool asBool() const;
+
+                /** Decoded string. */
+                std::string asString() const;
+
+                /** Raw string content in the source buffer, still escaped
+                    if escaped() is true. */
+                StringRef stringRef() const;
+                bool escaped() const;
+
+                /** Materializes the node (and its children) as a Value. */
+                Value value() const;
+            private:
+                friend class Document;
+                friend class iterator;
+                Node(const struct DocumentPrivate *aDocument, size_t aIndex)
+                    : iDocument(aDocument), iIndex(aIndex) { }
+                Node find(const char *aKey, size_t aLength) const;
+
+                const struct DocumentPrivate *iDocument;
+                size_t iIndex;
+            };
+        public:
+            Document();
+
+            /** Parses aData in place, the buffer must stay unchanged while
+                the document is used; aOwner is held to keep it alive. */
+            bool parse(const char *aData, size_t aLength,
+                       std::shared_ptr<const void> aOwner = std::shared_ptr<const void>());
+
+            /** Parses a private copy of aText. */
+            bool parse(const std::string &aText);
+
+            /** Memory maps aFilename and parses the mapping in place, the
+                mapping lives as long as the document. */
+            bool parseFile(const char *aFilename);
+
+            bool isValid() const;
+
+            /** Input offset of the last syntax error. */
+            size_t errorOffset() const;
+
+            Node root() const;
+            Node operator[](const std::string &aKey) const { return root()[aKey]; }
+            Node operator[](size_t aIndex) const { return root()[aIndex]; }
+        private:
+            std::shared_ptr<struct DocumentPrivate> iPIMPL;
+        };
+
+        /** Precompiled accessor for nested fields, in JSON Pointer syntax
+            (RFC 6901), e.g. "/results/0/owner/id". A '*' segment matches
+            every member or element. Evaluation never throws, a missing
+            field or a type mismatch simply does not match. */
+        class Path {
+        public:
+            Path();
+            explicit Path(const std::string &aPointer);
+
+            /** False if the expression was malformed (must be empty or start with '/'). */
+            bool isValid() const { return iValid; }
+
+            /** First match, nullptr / invalid node if nothing matches. */
+            const Value* find(const Value &aRoot) const;
+            Document::Node find(const Document::Node &aRoot) const;
+
+            /** Appends all matches to aOut, returns the number appended. */
+            size_t select(const Value &aRoot, std::vector<const Value*> &aOut) const;
+            size_t select(const Document::Node &aRoot, std::vector<Document::Node> &aOut) const;
+        private:
+            struct Segment {
+                std::string name;
+                size_t index;       // array index, npos if name is not one
+                bool wildcard;
+            };
+            template <class N>
+            bool first(const N &aNode, size_t aSegment, N &aResult) const;
+            template <class N, class Out>
+            void collect(const N &aNode, size_t aSegment, Out &aOut) const;
+        private:
+            std::vector<Segment> iSegments;
+            bool iValid;
+        };
+
         JSON::Value parseFile(const char *aFilename);
         JSON::Value parseString(const std::string &aString);
+
+        /** Parses with object keys interned into aKeys. */
+        JSON::Value parseString(const std::string &aString, KeyTable &aKeys);
+
+        /** JSON Merge Patch (RFC 7386) turning aOld into aNew: changed
+            members with their new value, removed members as null, nested
+            objects as patches of their own. A null member of aNew can not
+            be told apart from a removal and is sent as one.
+            @return empty object if nothing changed
+        */
+        JSON::Object diff(const JSON::Object &aOld, const JSON::Object &aNew);
+        JSON::Value diff(const JSON::Value &aOld, const JSON::Value &aNew);
+
+        /** Applies a merge patch (RFC 7386) in place. */
+        void merge(JSON::Object &aTarget, const JSON::Object &aPatch);
+        void merge(JSON::Value &aTarget, const JSON::Value &aPatch);
+
+        /** CBOR encoded Value. */
+        std::string toCBOR(const JSON::Value &aValue);
+        JSON::Value parseCBOR(const std::string &aData);
         
     } /* namespace JSON */
 
 } /* namespace QtC */
 
+namespace std {
+    template <>
+    struct hash<QtC::JSON::Value> {
+        size_t operator()(const QtC::JSON::Value &aValue) const { return (size_t)aValue.hash(); }
+    };
+    template <>
+    struct hash<QtC::JSON::Object> {
+        size_t operator()(const QtC::JSON::Object &aObject) const { return (size_t)aObject.hash(); }
+    };
+}
+
 /** Output operators */
+std::ostream& operator<<(std::ostream&, const QtC::JSON::Key&);
 std::ostream& operator<<(std::ostream&, const QtC::JSON::Value&);
 std::ostream& operator<<(std::ostream&, const QtC::JSON::Association&);
 std::ostream& operator<<(std::ostream&, const QtC::JSON::Object&);
@@ -0,0 +1,306 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONBinding.h
+** Comment:    Typed binding of user structs to JSON.
+*/
+
+#ifndef QTC_COMMON_JSON_BINDING_H
+#define QTC_COMMON_JSON_BINDING_H
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <QtC/Common/JSON.h>
+
+namespace QtC {
+
+    namespace JSON {
+
+        /** Field list of a struct. Specialize with QTC_JSON_BINDING, or by
+            hand when JSON names differ from member names:
+
+            template <> struct Binding<Movie> {
+                static const bool bound = true;
+                template <class Visitor> static void fields(Visitor &aVisitor) {
+                    aVisitor("_id", &Movie::id);
+                    aVisitor("title", &Movie::title);
+                }
+            };
+        */
+        template <class T>
+        struct Binding {
+            static const bool bound = false;
+        };
+
+        /*
+        ** Decoding from a Document. Members missing from the JSON keep
+        ** their value; false is returned on a type mismatch.
+        */
+        inline bool decode(const Document::Node &aNode, bool &aValue) {
+            if (aNode.type() != BOOL)
+                return false;
+            aValue = aNode.asBool();
+            return true;
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+        decode(const Document::Node &aNode, T &aValue) {
+            if (aNode.type() != INT)
+                return false;
+            long long int value = aNode.asInt();
+            if (value < (long long int)std::numeric_limits<T>::min() ||
+                value > (long long int)std::numeric_limits<T>::max())
+                return false;
+            aValue = (T)value;
+            return true;
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, bool>::type
+        decode(const Document::Node &aNode, T &aValue) {
+            if (aNode.type() != INT || aNode.asFloat() < 0)
+                return false;
+            unsigned long long int value = aNode.asUInt();
+            if (value > (unsigned long long int)std::numeric_limits<T>::max())
+                return false;
+            aValue = (T)value;
+            return true;
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+        decode(const Document::Node &aNode, T &aValue) {
+            if (aNode.type() != INT && aNode.type() != FLOAT)
+                return false;
+            aValue = (T)aNode.asFloat();
+            return true;
+        }
+
+        inline bool decode(const Document::Node &aNode, std::string &aValue) {
+            if (aNode.type() != STRING)
+                return false;
+            if (aNode.escaped()) {
+                aValue = aNode.asString();
+            } else {
+                // Reuses the capacity of aValue.
+                StringRef text = aNode.stringRef();
+                aValue.assign(text.data(), text.size());
+            }
+            return true;
+        }
+
+        inline bool decode(const Document::Node &aNode, Value &aValue) {
+            if (!aNode.valid())
+                return false;
+            aValue = aNode.value();
+            return true;
+        }
+
+        template <class T>
+        bool decode(const Document::Node &aNode, std::vector<T> &aValue) {
+            if (aNode.type() != ARRAY)
+                return false;
+            aValue.resize(aNode.size());
+
+            bool ok = true;
+            typename std::vector<T>::iterator element = aValue.begin();
+            for (Document::iterator i = aNode.begin(); i != aNode.end(); ++i, ++element) {
+                ok = decode(*i, *element) && ok;
+            }
+            return ok;
+        }
+
+        /* std::vector<bool> hands out proxies, not bool references. */
+        inline bool decode(const Document::Node &aNode, std::vector<bool> &aValue) {
+            if (aNode.type() != ARRAY)
+                return false;
+            aValue.resize(aNode.size());
+
+            bool ok = true;
+            size_t n = 0;
+            for (Document::iterator i = aNode.begin(); i != aNode.end(); ++i, ++n) {
+                bool element = aValue[n];
+                ok = decode(*i, element) && ok;
+                aValue[n] = element;
+            }
+            return ok;
+        }
+
+        /* Decodes one member into the bound field named like its key. */
+        template <class T>
+        struct FieldDecoder {
+            FieldDecoder(T &aObject)
+                : object(aObject), found(false), ok(true) { }
+
+            template <class M>
+            void operator()(const char *aName, M T::*aMember) {
+                if (found || strlen(aName) != key.size() || memcmp(aName, key.data(), key.size()) != 0)
+                    return;
+                found = true;
+                ok = decode(value, object.*aMember) && ok;
+            }
+
+            T &object;
+            StringRef key;
+            Document::Node value;
+            bool found;
+            bool ok;
+        };
+
+        /* One pass over the members, each key is matched against the
+           bound names; keys without a field are skipped. */
+        template <class T>
+        typename std::enable_if<Binding<T>::bound, bool>::type
+        decode(const Document::Node &aNode, T &aValue) {
+            if (aNode.type() != OBJECT)
+                return false;
+            FieldDecoder<T> decoder(aValue);
+            std::string unescaped;
+            for (Document::iterator i = aNode.begin(); i != aNode.end(); ++i) {
+                Document::Node key = i.key();
+                if (key.escaped()) {
+                    unescaped = key.asString();
+                    decoder.key = StringRef(unescaped);
+                } else {
+                    decoder.key = key.stringRef();
+                }
+                decoder.value = i.value();
+                decoder.found = false;
+                Binding<T>::fields(decoder);
+            }
+            return decoder.ok;
+        }
+
+        template <class T>
+        bool decode(const Document &aDocument, T &aValue) {
+            return decode(aDocument.root(), aValue);
+        }
+
+        /*
+        ** Encoding through a Writer.
+        */
+        inline void encode(Writer &aWriter, bool aValue) {
+            aWriter.boolean(aValue);
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+        encode(Writer &aWriter, T aValue) {
+            aWriter.integer(aValue);
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+        encode(Writer &aWriter, T aValue) {
+            aWriter.unsignedInteger(aValue);
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type
+        encode(Writer &aWriter, T aValue) {
+            aWriter.number((double)aValue);
+        }
+
+        inline void encode(Writer &aWriter, const std::string &aValue) {
+            aWriter.string(aValue);
+        }
+
+        inline void encode(Writer &aWriter, const Value &aValue) {
+            aWriter.write(aValue);
+        }
+
+        template <class T>
+        void encode(Writer &aWriter, const std::vector<T> &aValue) {
+            aWriter.beginArray();
+            for (typename std::vector<T>::const_iterator i = aValue.begin(); i != aValue.end(); ++i) {
+                encode(aWriter, *i);
+            }
+            aWriter.endArray();
+        }
+
+        template <class T>
+        struct FieldEncoder {
+            FieldEncoder(Writer &aWriter, const T &aObject)
+                : writer(aWriter), object(aObject) { }
+
+            template <class M>
+            void operator()(const char *aName, M T::*aMember) {
+                writer.key(aName, strlen(aName));
+                encode(writer, object.*aMember);
+            }
+
+            Writer &writer;
+            const T &object;
+        };
+
+        template <class T>
+        typename std::enable_if<Binding<T>::bound>::type
+        encode(Writer &aWriter, const T &aValue) {
+            FieldEncoder<T> encoder(aWriter, aValue);
+            aWriter.beginObject();
+            Binding<T>::fields(encoder);
+            aWriter.endObject();
+        }
+
+        /** Serializes a bound struct (or vector, string, ...). */
+        template <class T>
+        std::string toString(const T &aValue) {
+            Writer writer;
+            encode(writer, aValue);
+            return writer.str();
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
+
+/*
+** QTC_JSON_BINDING(Movie, title, year, actors) binds the listed members
+** under their own names (up to 24). Use at global scope.
+*/
+#define QTC_JSON_EXPAND(x) x
+#define QTC_JSON_FE_1(m, x) m(x)
+#define QTC_JSON_FE_2(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_1(m, __VA_ARGS__))
+#define QTC_JSON_FE_3(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_2(m, __VA_ARGS__))
+#define QTC_JSON_FE_4(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_3(m, __VA_ARGS__))
+#define QTC_JSON_FE_5(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_4(m, __VA_ARGS__))
+#define QTC_JSON_FE_6(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_5(m, __VA_ARGS__))
+#define QTC_JSON_FE_7(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_6(m, __VA_ARGS__))
+#define QTC_JSON_FE_8(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_7(m, __VA_ARGS__))
+#define QTC_JSON_FE_9(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_8(m, __VA_ARGS__))
+#define QTC_JSON_FE_10(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_9(m, __VA_ARGS__))
+#define QTC_JSON_FE_11(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_10(m, __VA_ARGS__))
+#define QTC_JSON_FE_12(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_11(m, __VA_ARGS__))
+#define QTC_JSON_FE_13(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_12(m, __VA_ARGS__))
+#define QTC_JSON_FE_14(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_13(m, __VA_ARGS__))
+#define QTC_JSON_FE_15(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_14(m, __VA_ARGS__))
+#define QTC_JSON_FE_16(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_15(m, __VA_ARGS__))
+#define QTC_JSON_FE_17(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_16(m, __VA_ARGS__))
+#define QTC_JSON_FE_18(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_17(m, __VA_ARGS__))
+#define QTC_JSON_FE_19(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_18(m, __VA_ARGS__))
+#define QTC_JSON_FE_20(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_19(m, __VA_ARGS__))
+#define QTC_JSON_FE_21(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_20(m, __VA_ARGS__))
+#define QTC_JSON_FE_22(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_21(m, __VA_ARGS__))
+#define QTC_JSON_FE_23(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_22(m, __VA_ARGS__))
+#define QTC_JSON_FE_24(m, x, ...) m(x) QTC_JSON_EXPAND(QTC_JSON_FE_23(m, __VA_ARGS__))
+#define QTC_JSON_FE_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, NAME, ...) NAME
+#define QTC_JSON_FOR_EACH(m, ...) \
+    QTC_JSON_EXPAND(QTC_JSON_FE_SELECT(__VA_ARGS__, QTC_JSON_FE_24, QTC_JSON_FE_23, QTC_JSON_FE_22, QTC_JSON_FE_21, QTC_JSON_FE_20, QTC_JSON_FE_19, QTC_JSON_FE_18, QTC_JSON_FE_17, QTC_JSON_FE_16, QTC_JSON_FE_15, QTC_JSON_FE_14, QTC_JSON_FE_13, QTC_JSON_FE_12, QTC_JSON_FE_11, QTC_JSON_FE_10, QTC_JSON_FE_9, QTC_JSON_FE_8, QTC_JSON_FE_7, QTC_JSON_FE_6, QTC_JSON_FE_5, QTC_JSON_FE_4, QTC_JSON_FE_3, QTC_JSON_FE_2, QTC_JSON_FE_1)(m, __VA_ARGS__))
+
+#define QTC_JSON_BINDING_FIELD(aMember) aVisitor(#aMember, &Type::aMember);
+
+#define QTC_JSON_BINDING(aType, ...) \
+    namespace QtC { namespace JSON { \
+        template <> struct Binding<aType> { \
+            typedef aType Type; \
+            static const bool bound = true; \
+            template <class Visitor> static void fields(Visitor &aVisitor) { \
+                QTC_JSON_FOR_EACH(QTC_JSON_BINDING_FIELD, __VA_ARGS__) \
+            } \
+        }; \
+    } }
+
+#endif /* QTC_COMMON_JSON_BINDING_H */
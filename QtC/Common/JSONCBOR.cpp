@@ -0,0 +1,464 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONCBOR.cpp
+** Comment:    CBOR (RFC 8949) encoding of JSON values.
+*/
+
+#include <stdint.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "QtC/Common/JSON.h"
+#include "QtC/Common/JSONPrivate.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        enum {
+            MajorUnsigned = 0,
+            MajorNegative = 1,
+            MajorBytes    = 2,
+            MajorText     = 3,
+            MajorArray    = 4,
+            MajorMap      = 5,
+            MajorTag      = 6,
+            MajorSimple   = 7
+        };
+
+        static const unsigned char gFalse = 0xf4;
+        static const unsigned char gTrue = 0xf5;
+        static const unsigned char gNull = 0xf6;
+        static const unsigned char gUndefined = 0xf7;
+        static const unsigned char gFloat16 = 0xf9;
+        static const unsigned char gFloat32 = 0xfa;
+        static const unsigned char gFloat64 = 0xfb;
+        static const unsigned char gBreak = 0xff;
+        static const unsigned int gIndefinite = 31;
+
+        /*
+        ** CBORWriter
+        */
+        CBORWriter::CBORWriter() {
+        }
+
+        void CBORWriter::clear() {
+            iBuffer.clear();
+            iIndefinite.clear();
+        }
+
+        void CBORWriter::head(unsigned int aMajor, unsigned long long int aArgument) {
+            char bytes[9];
+            unsigned char major = (unsigned char)(aMajor << 5);
+            size_t length;
+
+            if (aArgument < 24) {
+                bytes[0] = (char)(major | aArgument);
+                length = 1;
+            } else if (aArgument <= 0xff) {
+                bytes[0] = (char)(major | 24);
+                length = 2;
+            } else if (aArgument <= 0xffff) {
+                bytes[0] = (char)(major | 25);
+                length = 3;
+            } else if (aArgument <= 0xffffffffULL) {
+                bytes[0] = (char)(major | 26);
+                length = 5;
+            } else {
+                bytes[0] = (char)(major | 27);
+                length = 9;
+            }
+            // Big endian argument
+            for (size_t n = length - 1; n > 0; --n) {
+                bytes[n] = (char)(aArgument & 0xff);
+                aArgument >>= 8;
+            }
+            iBuffer.append(bytes, length);
+        }
+
+        void CBORWriter::close() {
+            if (iIndefinite.back())
+                iBuffer += (char)gBreak;
+            iIndefinite.pop_back();
+        }
+
+        CBORWriter& CBORWriter::beginObject() {
+            iBuffer += (char)((MajorMap << 5) | gIndefinite);
+            iIndefinite.push_back(true);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::beginObject(size_t aSize) {
+            head(MajorMap, aSize);
+            iIndefinite.push_back(false);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::endObject() {
+            close();
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::beginArray() {
+            iBuffer += (char)((MajorArray << 5) | gIndefinite);
+            iIndefinite.push_back(true);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::beginArray(size_t aSize) {
+            head(MajorArray, aSize);
+            iIndefinite.push_back(false);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::endArray() {
+            close();
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::null() {
+            iBuffer += (char)gNull;
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::boolean(bool aValue) {
+            iBuffer += (char)(aValue ? gTrue : gFalse);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::integer(long long int aValue) {
+            if (aValue < 0)
+                head(MajorNegative, (unsigned long long int)(-1 - aValue));
+            else
+                head(MajorUnsigned, (unsigned long long int)aValue);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::unsignedInteger(unsigned long long int aValue) {
+            head(MajorUnsigned, aValue);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::number(double aValue) {
+            // Narrowing a finite double beyond the float range is undefined.
+            bool narrow = !std::isfinite(aValue) || std::fabs(aValue) <= FLT_MAX;
+            float single = narrow ? (float)aValue : 0.0f;
+            if (narrow && ((double)single == aValue || aValue != aValue)) {
+                // Exact in single precision (NaN included), half the size.
+                uint32_t bits;
+                memcpy(&bits, &single, 4);
+                iBuffer += (char)gFloat32;
+                for (int shift = 24; shift >= 0; shift -= 8)
+                    iBuffer += (char)((bits >> shift) & 0xff);
+            } else {
+                uint64_t bits;
+                memcpy(&bits, &aValue, 8);
+                iBuffer += (char)gFloat64;
+                for (int shift = 56; shift >= 0; shift -= 8)
+                    iBuffer += (char)((bits >> shift) & 0xff);
+            }
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::string(const char *aData, size_t aLength) {
+            head(MajorText, aLength);
+            iBuffer.append(aData, aLength);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::bytes(const char *aData, size_t aLength) {
+            head(MajorBytes, aLength);
+            iBuffer.append(aData, aLength);
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::write(const Value &aValue) {
+            switch(aValue.type()) {
+            case INT:    return aValue.is_unsigned() ? unsignedInteger(aValue.as_uint())
+                                                 : integer(aValue.as_int());
+            case FLOAT:  return number(aValue.as_float());
+            case BOOL:   return boolean(aValue.as_bool());
+            case NIL:    return null();
+            case STRING: return string(aValue.string_ref());
+            case ARRAY:  return write(aValue.array_ref());
+            case OBJECT: return write(aValue.object_ref());
+            }
+            return *this;
+        }
+
+        CBORWriter& CBORWriter::write(const Object &aObject) {
+            beginObject(aObject.size());
+            for (Object::const_iterator i = aObject.begin(); i != aObject.end(); ++i) {
+                key(i->first.str());
+                write(i->second);
+            }
+            return endObject();
+        }
+
+        CBORWriter& CBORWriter::write(const Array &aArray) {
+            beginArray(aArray.size());
+            for (vector<Value>::const_iterator i = aArray.begin(); i != aArray.end(); ++i) {
+                write(*i);
+            }
+            return endArray();
+        }
+
+        /*
+        ** CBORReader
+        */
+        static inline uint64_t readBigEndian(const unsigned char *p, size_t aLength) {
+            uint64_t value = 0;
+            for (size_t n = 0; n < aLength; ++n)
+                value = (value << 8) | p[n];
+            return value;
+        }
+
+        static double halfToDouble(unsigned int aHalf) {
+            int exponent = (aHalf >> 10) & 0x1f;
+            double mantissa = aHalf & 0x3ff;
+            double value;
+
+            if (exponent == 0)
+                value = ldexp(mantissa, -24);
+            else if (exponent != 31)
+                value = ldexp(mantissa + 1024, exponent - 25);
+            else
+                value = (mantissa == 0) ? HUGE_VAL : NAN;
+            return (aHalf & 0x8000) ? -value : value;
+        }
+
+        CBORReader::CBORReader()
+            : iBegin(nullptr), iComplete(false), iError(false), iErrorOffset(0)
+        {
+        }
+
+        const char *CBORReader::fail(const char *p) {
+            iError = true;
+            iErrorOffset = p - iBegin;
+            return nullptr;
+        }
+
+        /* An item has been completed, advances the enclosing container. */
+        bool CBORReader::done(Handler &aHandler) {
+            while (!iStack.empty()) {
+                Frame &frame = iStack.back();
+                if (frame.map) {
+                    // A key is followed by its value.
+                    frame.key = !frame.key;
+                    if (!frame.key)
+                        return true;
+                }
+                if (frame.indefinite || --frame.remaining > 0)
+                    return true;
+                // Definite container complete.
+                bool map = frame.map;
+                iStack.pop_back();
+                if (!(map ? aHandler.endObject() : aHandler.endArray()))
+                    return false;
+            }
+            iComplete = true;
+            return true;
+        }
+
+        /* Indefinite length string, a sequence of definite chunks. */
+        const char *CBORReader::chunks(const char *p, const char *end, unsigned int aMajor,
+                                       Handler &aHandler, bool aKey)
+        {
+            iScratch.clear();
+            while (true) {
+                if (p == end)
+                    return fail(p);
+                unsigned char initial = (unsigned char)*p;
+                if (initial == gBreak) {
+                    ++p;
+                    break;
+                }
+                unsigned int info = initial & 0x1f;
+                if ((initial >> 5) != aMajor || info > 27)
+                    return fail(p);
+                size_t size = (info < 24) ? 0 : ((size_t)1 << (info - 24));
+                if ((size_t)(end - p - 1) < size)
+                    return fail(p);
+                uint64_t length = (info < 24) ? info : readBigEndian((const unsigned char *)p + 1, size);
+                p += 1 + size;
+                if ((uint64_t)(end - p) < length)
+                    return fail(p);
+                iScratch.append(p, (size_t)length);
+                p += length;
+            }
+
+            bool go;
+            if (aMajor == MajorText) {
+                if (validateUTF8(iScratch.data(), iScratch.data() + iScratch.size()))
+                    return fail(p);
+                go = aKey ? aHandler.key(iScratch.data(), iScratch.size())
+                          : aHandler.string(iScratch.data(), iScratch.size());
+            } else {
+                go = aHandler.bytes(iScratch.data(), iScratch.size());
+            }
+            return (go && done(aHandler)) ? p : nullptr;
+        }
+
+        const char *CBORReader::item(const char *p, const char *end, Handler &aHandler) {
+            const char *start = p;
+            unsigned char initial = (unsigned char)*p++;
+            unsigned int major = initial >> 5;
+            unsigned int info = initial & 0x1f;
+            bool key = !iStack.empty() && iStack.back().key;
+            uint64_t argument = info;
+
+            if (initial == gBreak) {
+                // End of an indefinite container, not between key and value.
+                if (iStack.empty() || !iStack.back().indefinite ||
+                    (iStack.back().map && !iStack.back().key))
+                    return fail(start);
+                bool map = iStack.back().map;
+                iStack.pop_back();
+                if (!(map ? aHandler.endObject() : aHandler.endArray()))
+                    return nullptr;
+                return done(aHandler) ? p : nullptr;
+            }
+
+            if (info >= 24 && info <= 27) {
+                size_t size = (size_t)1 << (info - 24);
+                if ((size_t)(end - p) < size)
+                    return fail(start);
+                argument = readBigEndian((const unsigned char *)p, size);
+                p += size;
+            } else if (info > 27 && !(info == gIndefinite && major >= MajorBytes && major <= MajorMap)) {
+                return fail(start);
+            }
+
+            if (key && major != MajorText)
+                return fail(start);
+
+            bool go = true;
+            switch (major) {
+            case MajorUnsigned:
+                if (argument <= (uint64_t)INT64_MAX)
+                    go = aHandler.integer((long long int)argument);
+                else
+                    go = aHandler.unsignedInteger(argument);
+                break;
+            case MajorNegative:
+                if (argument <= (uint64_t)INT64_MAX)
+                    go = aHandler.integer(-1 - (long long int)argument);
+                else
+                    go = aHandler.number(-1.0 - (double)argument);
+                break;
+            case MajorBytes:
+            case MajorText:
+                if (info == gIndefinite)
+                    return chunks(p, end, major, aHandler, key);
+                if ((uint64_t)(end - p) < argument)
+                    return fail(start);
+                if (major == MajorText) {
+                    if (validateUTF8(p, p + argument))
+                        return fail(start);
+                    go = key ? aHandler.key(p, (size_t)argument) : aHandler.string(p, (size_t)argument);
+                } else {
+                    go = aHandler.bytes(p, (size_t)argument);
+                }
+                p += argument;
+                break;
+            case MajorArray:
+            case MajorMap: {
+                bool map = (major == MajorMap);
+                if (!(map ? aHandler.beginObject() : aHandler.beginArray()))
+                    return nullptr;
+                if (info != gIndefinite && argument == 0) {
+                    if (!(map ? aHandler.endObject() : aHandler.endArray()))
+                        return nullptr;
+                    break;
+                }
+                Frame frame = { argument, info == gIndefinite, map, map };
+                iStack.push_back(frame);
+                return p;
+            }
+            case MajorTag:
+                // Tags only annotate, the tagged item follows.
+                return p;
+            case MajorSimple:
+                switch (initial) {
+                case gFalse:     go = aHandler.boolean(false); break;
+                case gTrue:      go = aHandler.boolean(true); break;
+                case gNull:
+                case gUndefined: go = aHandler.null(); break;
+                case gFloat16:   go = aHandler.number(halfToDouble((unsigned int)argument)); break;
+                case gFloat32: {
+                    uint32_t bits = (uint32_t)argument;
+                    float value;
+                    memcpy(&value, &bits, 4);
+                    go = aHandler.number(value);
+                    break;
+                }
+                case gFloat64: {
+                    double value;
+                    memcpy(&value, &argument, 8);
+                    go = aHandler.number(value);
+                    break;
+                }
+                default:
+                    return fail(start);
+                }
+                break;
+            }
+            if (!go)
+                return nullptr;
+            return done(aHandler) ? p : nullptr;
+        }
+
+        Reader::Status CBORReader::parse(const std::string &aData, Handler &aHandler) {
+            return parse(aData.data(), aData.size(), aHandler);
+        }
+
+        Reader::Status CBORReader::parse(const char *aData, size_t aLength, Handler &aHandler) {
+            const char *p = aData;
+            const char *end = aData + aLength;
+
+            iBegin = aData;
+            iStack.clear();
+            iComplete = false;
+            iError = false;
+            iErrorOffset = 0;
+
+            while (!iComplete) {
+                if (p == end) {
+                    fail(p);
+                    return Reader::SyntaxError;
+                }
+                const char *next = item(p, end, aHandler);
+                if (next == nullptr)
+                    return iError ? Reader::SyntaxError : Reader::Aborted;
+                p = next;
+            }
+            if (p != end) {
+                fail(p);
+                return Reader::SyntaxError;
+            }
+            return Reader::Complete;
+        }
+
+        /*
+        ** Value conversion
+        */
+        std::string toCBOR(const Value &aValue) {
+            CBORWriter writer;
+            writer.write(aValue);
+            return writer.str();
+        }
+
+        Value parseCBOR(const std::string &aData) {
+            CBORReader reader;
+            ValueBuilder builder;
+            if (reader.parse(aData, builder) != Reader::Complete)
+                throw std::runtime_error("Error parsing CBOR data.");
+            return move(builder.value());
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
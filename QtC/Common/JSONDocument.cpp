@@ -0,0 +1,467 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONDocument.cpp
+*/
+
+#include <stdint.h>
+#include <cstring>
+#include <limits>
+
+#include "QtC/Common/JSON.h"
+#include "QtC/Common/JSONPrivate.h"
+#include "QtC/Common/MappedFile.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        /*
+        ** Tape entry, one per value and per object key. Containers are
+        ** followed by their members (key, value, key, value, ...) or
+        ** elements; 'next' skips over the whole subtree.
+        */
+        struct DocumentEntry {
+            uint32_t tag;       // ValueType | flags
+            uint32_t length;    // token length, members/elements for containers
+            uint32_t offset;    // token start, after the quote for strings
+            uint32_t next;      // tape index of the following sibling
+        };
+
+        enum {
+            TagTypeMask = 0x0f,
+            TagEscaped  = 0x10,     // string contains escapes
+            TagTrue     = 0x20      // boolean value
+        };
+
+        struct DocumentPrivate {
+            DocumentPrivate()
+                : data(nullptr), length(0), valid(false), errorOffset(0)
+            {}
+
+            bool parse();
+            const char *fail(const char *p);
+            const char *string(const char *p, const char *end);
+            const char *member(const char *p, const char *end);
+            const char *number(const char *p, const char *end);
+            const char *literal(const char *p, const char *end);
+
+            uint32_t push(uint32_t aTag, const char *aToken, size_t aLength) {
+                uint32_t index = (uint32_t)tape.size();
+                DocumentEntry entry = { aTag, (uint32_t)aLength, (uint32_t)(aToken - data), index + 1 };
+                tape.push_back(entry);
+                return index;
+            }
+
+            const DocumentEntry& entry(size_t aIndex) const { return tape[aIndex]; }
+            ValueType type(size_t aIndex) const { return (ValueType)(tape[aIndex].tag & TagTypeMask); }
+            const char *token(size_t aIndex) const { return data + tape[aIndex].offset; }
+
+            std::shared_ptr<const void> owner;
+            const char *data;
+            size_t length;
+            std::vector<DocumentEntry> tape;
+            bool valid;
+            size_t errorOffset;
+        };
+
+        /* Checks the escapes of [p, end) without decoding. */
+        static const char *validateEscapes(const char *p, const char *end) {
+            while ((p = findQuoteEscapeOrControl(p, end)) != end) {
+                if (readEscape(++p, end) < 0)
+                    return p;
+            }
+            return nullptr;
+        }
+
+        const char *DocumentPrivate::fail(const char *p) {
+            errorOffset = p - data;
+            return nullptr;
+        }
+
+        const char *DocumentPrivate::string(const char *p, const char *end) {
+            const char *begin = ++p;
+            const char *nonASCII;
+            bool escaped;
+
+            p = scanString(p, end, escaped, nonASCII);
+            if (p == end || *p != '"')
+                return fail(p);
+            if (nonASCII) {
+                const char *error = validateUTF8(nonASCII, p);
+                if (error)
+                    return fail(error);
+            }
+            if (escaped) {
+                const char *error = validateEscapes(begin, p);
+                if (error)
+                    return fail(error);
+            }
+            push(STRING | (escaped ? TagEscaped : 0), begin, p - begin);
+            return p + 1;
+        }
+
+        /* Object member name and ':', p at the opening quote. */
+        const char *DocumentPrivate::member(const char *p, const char *end) {
+            if (p == end || *p != '"')
+                return fail(p);
+            if ((p = string(p, end)) == nullptr)
+                return nullptr;
+            p = skipWhitespace(p, end);
+            if (p == end || *p != ':')
+                return fail(p);
+            return skipWhitespace(p + 1, end);
+        }
+
+        const char *DocumentPrivate::number(const char *p, const char *end) {
+            const char *begin = p;
+            const char *error = nullptr;
+            bool integral;
+
+            p = scanNumber(p, end, integral, error);
+            if (p == nullptr)
+                return fail(error);
+
+            // Integers which may not fit 64 bits are decided now.
+            if (integral && p - begin > 18)
+                integral = toNumber(begin, p, true).type != Number::Float;
+            push(integral ? INT : FLOAT, begin, p - begin);
+            return p;
+        }
+
+        const char *DocumentPrivate::literal(const char *p, const char *end) {
+            size_t left = end - p;
+
+            if (left >= 4 && memcmp(p, "true", 4) == 0) {
+                push(BOOL | TagTrue, p, 4);
+                return p + 4;
+            }
+            if (left >= 5 && memcmp(p, "false", 5) == 0) {
+                push(BOOL, p, 5);
+                return p + 5;
+            }
+            if (left >= 4 && memcmp(p, "null", 4) == 0) {
+                push(NIL, p, 4);
+                return p + 4;
+            }
+            return fail(p);
+        }
+
+        bool DocumentPrivate::parse() {
+            const char *p = data;
+            const char *end = data + length;
+            std::vector<uint32_t> stack;    // open containers
+
+            tape.clear();
+            tape.reserve(length / 8 + 4);
+
+            p = skipWhitespace(p, end);
+            while (true) {
+                // A value is expected at p.
+                if (p == end) {
+                    fail(p);
+                    return false;
+                }
+
+                switch (*p) {
+                case '{':
+                case '[': {
+                    bool object = (*p == '{');
+                    uint32_t index = push(object ? OBJECT : ARRAY, p, 0);
+                    p = skipWhitespace(p + 1, end);
+                    if (p != end && *p == (object ? '}' : ']')) {
+                        p = skipWhitespace(p + 1, end);
+                        break;
+                    }
+                    stack.push_back(index);
+                    if (object && (p = member(p, end)) == nullptr)
+                        return false;
+                    continue;
+                }
+                case '"':
+                    p = string(p, end);
+                    break;
+                case '-': case '0': case '1': case '2': case '3': case '4':
+                case '5': case '6': case '7': case '8': case '9':
+                    p = number(p, end);
+                    break;
+                default:
+                    p = literal(p, end);
+                    break;
+                }
+                if (p == nullptr)
+                    return false;
+
+                // Value done, continue in the enclosing containers.
+                p = skipWhitespace(p, end);
+                while (!stack.empty()) {
+                    DocumentEntry &container = tape[stack.back()];
+                    bool object = (container.tag & TagTypeMask) == OBJECT;
+
+                    ++container.length;
+                    if (p == end) {
+                        fail(p);
+                        return false;
+                    }
+                    if (*p == ',') {
+                        p = skipWhitespace(p + 1, end);
+                        if (object && (p = member(p, end)) == nullptr)
+                            return false;
+                        break;
+                    }
+                    if (*p != (object ? '}' : ']')) {
+                        fail(p);
+                        return false;
+                    }
+                    container.next = (uint32_t)tape.size();
+                    stack.pop_back();
+                    p = skipWhitespace(p + 1, end);
+                }
+                if (stack.empty()) {
+                    if (p != end) {
+                        fail(p);
+                        return false;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        /*
+        ** Document
+        */
+        Document::Document()
+            : iPIMPL(std::make_shared<DocumentPrivate>())
+        {
+        }
+
+        bool Document::parse(const char *aData, size_t aLength, std::shared_ptr<const void> aOwner) {
+            iPIMPL = std::make_shared<DocumentPrivate>();
+            iPIMPL->owner = aOwner;
+            iPIMPL->data = aData;
+            iPIMPL->length = aLength;
+            if (aLength >= std::numeric_limits<uint32_t>::max()) {
+                iPIMPL->errorOffset = 0;
+                return false;
+            }
+            iPIMPL->valid = iPIMPL->parse();
+            if (!iPIMPL->valid)
+                iPIMPL->tape.clear();
+            return iPIMPL->valid;
+        }
+
+        bool Document::parse(const std::string &aText) {
+            std::shared_ptr<const std::string> copy = std::make_shared<std::string>(aText);
+            return parse(copy->data(), copy->size(), copy);
+        }
+
+        bool Document::parseFile(const char *aFilename) {
+            std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+            if (!file->open(aFilename, MappedFile::Random)) {
+                iPIMPL = std::make_shared<DocumentPrivate>();
+                return false;
+            }
+            return parse(file->data(), file->size(), file);
+        }
+
+        bool Document::isValid() const {
+            return iPIMPL->valid;
+        }
+
+        size_t Document::errorOffset() const {
+            return iPIMPL->errorOffset;
+        }
+
+        Document::Node Document::root() const {
+            if (!iPIMPL->valid)
+                return Node();
+            return Node(iPIMPL.get(), 0);
+        }
+
+        /*
+        ** Document::iterator
+        */
+        Document::Node Document::iterator::key() const {
+            if (!iObject)
+                return Node();
+            return Node(iDocument, iIndex);
+        }
+
+        Document::Node Document::iterator::value() const {
+            return Node(iDocument, iObject ? iIndex + 1 : iIndex);
+        }
+
+        Document::iterator& Document::iterator::operator++() {
+            iIndex = iDocument->entry(iObject ? iIndex + 1 : iIndex).next;
+            return *this;
+        }
+
+        /*
+        ** Document::Node
+        */
+        ValueType Document::Node::type() const {
+            if (!iDocument)
+                return NIL;
+            return iDocument->type(iIndex);
+        }
+
+        size_t Document::Node::size() const {
+            ValueType t = type();
+            if (t != OBJECT && t != ARRAY)
+                return 0;
+            return iDocument->entry(iIndex).length;
+        }
+
+        Document::Node Document::Node::find(const char *aKey, size_t aLength) const {
+            if (type() != OBJECT)
+                return Node();
+
+            size_t end = iDocument->entry(iIndex).next;
+            std::string decoded;
+            for (size_t i = iIndex + 1; i < end; i = iDocument->entry(i + 1).next) {
+                const DocumentEntry &key = iDocument->entry(i);
+                if (key.tag & TagEscaped) {
+                    decoded.clear();
+                    unescape(iDocument->token(i), iDocument->token(i) + key.length, decoded);
+                    if (decoded.size() == aLength && memcmp(decoded.data(), aKey, aLength) == 0)
+                        return Node(iDocument, i + 1);
+                } else if (key.length == aLength && memcmp(iDocument->token(i), aKey, aLength) == 0) {
+                    return Node(iDocument, i + 1);
+                }
+            }
+            return Node();
+        }
+
+        Document::Node Document::Node::operator[](const std::string &aKey) const {
+            return find(aKey.data(), aKey.size());
+        }
+
+        Document::Node Document::Node::operator[](size_t aIndex) const {
+            if (type() != ARRAY || aIndex >= size())
+                return Node();
+
+            size_t i = iIndex + 1;
+            while (aIndex-- > 0)
+                i = iDocument->entry(i).next;
+            return Node(iDocument, i);
+        }
+
+        Document::iterator Document::Node::begin() const {
+            if (!iDocument)
+                return iterator();
+            return iterator(iDocument, iIndex + 1, type() == OBJECT);
+        }
+
+        Document::iterator Document::Node::end() const {
+            if (!iDocument)
+                return iterator();
+            return iterator(iDocument, iDocument->entry(iIndex).next, type() == OBJECT);
+        }
+
+        static Number nodeNumber(const DocumentPrivate *aDocument, size_t aIndex) {
+            const char *token = aDocument->token(aIndex);
+            return toNumber(token, token + aDocument->entry(aIndex).length, aDocument->type(aIndex) == INT);
+        }
+
+        long long int Document::Node::asInt() const {
+            ValueType t = type();
+            if (t != INT && t != FLOAT)
+                return 0;
+
+            Number number = nodeNumber(iDocument, iIndex);
+            switch (number.type) {
+            case Number::Integer:  return number.integer;
+            case Number::Unsigned: return (long long int)number.uinteger;
+            default:               return (long long int)number.real;
+            }
+        }
+
+        unsigned long long int Document::Node::asUInt() const {
+            ValueType t = type();
+            if (t != INT && t != FLOAT)
+                return 0;
+
+            Number number = nodeNumber(iDocument, iIndex);
+            switch (number.type) {
+            case Number::Integer:  return (unsigned long long int)number.integer;
+            case Number::Unsigned: return number.uinteger;
+            default:               return (unsigned long long int)number.real;
+            }
+        }
+
+        double Document::Node::asFloat() const {
+            ValueType t = type();
+            if (t != INT && t != FLOAT)
+                return 0.0;
+
+            Number number = nodeNumber(iDocument, iIndex);
+            switch (number.type) {
+            case Number::Integer:  return (double)number.integer;
+            case Number::Unsigned: return (double)number.uinteger;
+            default:               return number.real;
+            }
+        }
+
+        bool Document::Node::asBool() const {
+            if (type() != BOOL)
+                return false;
+            return (iDocument->entry(iIndex).tag & TagTrue) != 0;
+        }
+
+        std::string Document::Node::asString() const {
+            std::string result;
+            if (type() != STRING)
+                return result;
+
+            const char *token = iDocument->token(iIndex);
+            size_t length = iDocument->entry(iIndex).length;
+            if (escaped())
+                unescape(token, token + length, result);
+            else
+                result.assign(token, length);
+            return result;
+        }
+
+        StringRef Document::Node::stringRef() const {
+            if (type() != STRING)
+                return StringRef();
+            return StringRef(iDocument->token(iIndex), iDocument->entry(iIndex).length);
+        }
+
+        bool Document::Node::escaped() const {
+            return type() == STRING && (iDocument->entry(iIndex).tag & TagEscaped) != 0;
+        }
+
+        Value Document::Node::value() const {
+            switch (type()) {
+            case INT: {
+                Number number = nodeNumber(iDocument, iIndex);
+                if (number.type == Number::Unsigned)
+                    return Value(number.uinteger);
+                return Value(number.integer);
+            }
+            case FLOAT:  return Value(asFloat());
+            case BOOL:   return Value(asBool());
+            case NIL:    return Value();
+            case STRING: return Value(asString());
+            case OBJECT: {
+                Object object;
+                for (iterator i = begin(); i != end(); ++i) {
+                    object.add(Key(i.key().asString()), i.value().value());
+                }
+                return Value(std::move(object));
+            }
+            case ARRAY: {
+                Array array;
+                for (iterator i = begin(); i != end(); ++i) {
+                    array.push_back(i.value().value());
+                }
+                return Value(std::move(array));
+            }
+            }
+            return Value();
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
@@ -0,0 +1,171 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONNumber.cpp
+** Comment:    Exact, locale independent conversion of JSON numbers.
+*/
+
+#include <stdint.h>
+#include <cfloat>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "QtC/Common/JSONPrivate.h"
+
+namespace QtC {
+
+    namespace JSON {
+
+        /* Powers of ten exactly representable as double. */
+        static const double gPow10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        static const uint64_t gMaxExactInteger = 1ULL << 53;
+
+        /* Correctly rounded conversion by strtod. The token is copied with
+           the decimal point of the current C locale, so the result does
+           not depend on it. */
+        static double slowDouble(const char *aBegin, const char *aEnd) {
+            const char *point = localeconv()->decimal_point;
+            size_t pointLength = strlen(point);
+            char buffer[128];
+            std::string text;
+            const char *c;
+
+            if (pointLength == 1 && (size_t)(aEnd - aBegin) < sizeof(buffer)) {
+                char *q = buffer;
+                for (const char *p = aBegin; p != aEnd; ++p)
+                    *q++ = (*p == '.') ? point[0] : *p;
+                *q = 0;
+                c = buffer;
+            } else {
+                for (const char *p = aBegin; p != aEnd; ++p) {
+                    if (*p == '.')
+                        text.append(point, pointLength);
+                    else
+                        text += *p;
+                }
+                c = text.c_str();
+            }
+            return strtod(c, nullptr);
+        }
+
+        Number toNumber(const char *aBegin, const char *aEnd, bool aIntegral) {
+            Number number;
+            const char *p = aBegin;
+            bool negative = (*p == '-');
+
+            number.integer = 0;
+            number.uinteger = 0;
+            if (negative)
+                ++p;
+
+            if (aIntegral) {
+                // Full 64 bit range, falls back to double beyond it.
+                uint64_t value = 0;
+                bool overflow = false;
+                for (; p != aEnd; ++p) {
+                    unsigned int digit = *p - '0';
+                    if (value > (UINT64_MAX - digit) / 10) {
+                        overflow = true;
+                        break;
+                    }
+                    value = value * 10 + digit;
+                }
+                if (!overflow) {
+                    if (!negative && value <= (uint64_t)INT64_MAX) {
+                        number.type = Number::Integer;
+                        number.integer = (long long int)value;
+                        return number;
+                    }
+                    if (!negative) {
+                        number.type = Number::Unsigned;
+                        number.uinteger = value;
+                        return number;
+                    }
+                    if (value <= (uint64_t)INT64_MAX + 1) {
+                        number.type = Number::Integer;
+                        number.integer = (long long int)(0 - value);
+                        return number;
+                    }
+                }
+                p = negative ? aBegin + 1 : aBegin;
+            }
+
+            number.type = Number::Float;
+
+            // Up to 19 significant digits are collected into the mantissa.
+            uint64_t mantissa = 0;
+            int digits = 0;
+            int exponent = 0;
+            bool truncated = false;
+
+            for (; p != aEnd && isDigit(*p); ++p) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    if (mantissa != 0)
+                        ++digits;
+                } else {
+                    ++exponent;
+                    truncated |= (*p != '0');
+                }
+            }
+            if (p != aEnd && *p == '.') {
+                for (++p; p != aEnd && isDigit(*p); ++p) {
+                    if (digits < 19) {
+                        mantissa = mantissa * 10 + (*p - '0');
+                        if (mantissa != 0)
+                            ++digits;
+                        --exponent;
+                    } else {
+                        truncated |= (*p != '0');
+                    }
+                }
+            }
+            if (p != aEnd && (*p == 'e' || *p == 'E')) {
+                bool negativeExponent = false;
+                int value = 0;
+                if (*++p == '-' || *p == '+')
+                    negativeExponent = (*p++ == '-');
+                for (; p != aEnd; ++p) {
+                    if (value < 100000)
+                        value = value * 10 + (*p - '0');
+                }
+                exponent += negativeExponent ? -value : value;
+            }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+            // Clinger's fast path: mantissa and power of ten are both exact
+            // doubles, so a single (correctly rounded) operation is exact.
+            if (!truncated && mantissa <= gMaxExactInteger) {
+                double value = (double)mantissa;
+                bool exact = true;
+
+                if (mantissa == 0 || exponent == 0) {
+                    // value as is
+                } else if (exponent > 0 && exponent <= 22) {
+                    value *= gPow10[exponent];
+                } else if (exponent < 0 && exponent >= -22) {
+                    value /= gPow10[-exponent];
+                } else if (exponent > 22 && exponent <= 22 + 15 &&
+                           mantissa <= gMaxExactInteger / (uint64_t)gPow10[exponent - 22]) {
+                    // Moving digits into the mantissa keeps it exact.
+                    value = (double)(mantissa * (uint64_t)gPow10[exponent - 22]) * gPow10[22];
+                } else {
+                    exact = false;
+                }
+                if (exact) {
+                    number.real = negative ? -value : value;
+                    return number;
+                }
+            }
+#endif
+            number.real = slowDouble(aBegin, aEnd);
+            return number;
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
@@ -0,0 +1,72 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONPatch.cpp
+** Comment:    Structural diff and JSON Merge Patch (RFC 7386).
+*/
+
+#include "QtC/Common/JSON.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        /*
+        ** diff
+        */
+        Object diff(const Object &aOld, const Object &aNew) {
+            Object patch;
+
+            for (Object::const_iterator i = aOld.begin(); i != aOld.end(); ++i) {
+                if (aNew.find(i->first) == aNew.end())
+                    patch.add(i->first, Value());
+            }
+            for (Object::const_iterator i = aNew.begin(); i != aNew.end(); ++i) {
+                Object::const_iterator old = aOld.find(i->first);
+                if (old == aOld.end()) {
+                    patch.add(i->first, Value(i->second));
+                } else if (old->second.type() == OBJECT && i->second.type() == OBJECT) {
+                    Object nested = diff(old->second.object_ref(), i->second.object_ref());
+                    if (nested.size() > 0)
+                        patch.add(i->first, Value(move(nested)));
+                } else if (old->second != i->second) {
+                    // Arrays and scalars are replaced as a whole.
+                    patch.add(i->first, Value(i->second));
+                }
+            }
+            return patch;
+        }
+
+        Value diff(const Value &aOld, const Value &aNew) {
+            if (aOld.type() == OBJECT && aNew.type() == OBJECT)
+                return Value(diff(aOld.object_ref(), aNew.object_ref()));
+            // Anything but an object patch replaces the target.
+            return aNew;
+        }
+
+        /*
+        ** merge
+        */
+        void merge(Object &aTarget, const Object &aPatch) {
+            for (Object::const_iterator i = aPatch.begin(); i != aPatch.end(); ++i) {
+                if (i->second.type() == NIL) {
+                    aTarget.erase(i->first);
+                } else {
+                    merge(aTarget.insert(i->first, Value()).first->second, i->second);
+                }
+            }
+        }
+
+        void merge(Value &aTarget, const Value &aPatch) {
+            if (aPatch.type() != OBJECT) {
+                aTarget = aPatch;
+                return;
+            }
+            if (aTarget.type() != OBJECT)
+                aTarget = Object();
+            merge(aTarget.object_ref(), aPatch.object_ref());
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
@@ -0,0 +1,184 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONPath.cpp
+*/
+
+#include <cstdlib>
+
+#include "QtC/Common/JSON.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        /*
+        ** Uniform child access for Value and Document::Node, so that the
+        ** evaluation below is written once.
+        */
+        static const Value* child(const Value *aValue, const string &aName, size_t aIndex) {
+            if (aValue->type() == OBJECT) {
+                const Object &object = aValue->object_ref();
+                Object::const_iterator i = object.find(aName);
+                return (i != object.end()) ? &i->second : nullptr;
+            }
+            if (aValue->type() == ARRAY && aIndex < aValue->array_ref().size())
+                return &aValue->array_ref()[aIndex];
+            return nullptr;
+        }
+
+        static Document::Node child(const Document::Node &aNode, const string &aName, size_t aIndex) {
+            if (aNode.type() == OBJECT)
+                return aNode[aName];
+            if (aNode.type() == ARRAY && aIndex != string::npos)
+                return aNode[aIndex];
+            return Document::Node();
+        }
+
+        static bool matched(const Value *aValue) { return aValue != nullptr; }
+        static bool matched(const Document::Node &aNode) { return aNode.valid(); }
+
+        static void append(const Value *aValue, vector<const Value*> &aOut) { aOut.push_back(aValue); }
+        static void append(const Document::Node &aNode, vector<Document::Node> &aOut) { aOut.push_back(aNode); }
+
+        template <class Out>
+        static void children(const Value *aValue, Out aOut) {
+            if (aValue->type() == OBJECT) {
+                const Object &object = aValue->object_ref();
+                for (Object::const_iterator i = object.begin(); i != object.end(); ++i)
+                    if (!aOut(&i->second)) return;
+            } else if (aValue->type() == ARRAY) {
+                const Array &array = aValue->array_ref();
+                for (vector<Value>::const_iterator i = array.begin(); i != array.end(); ++i)
+                    if (!aOut(&*i)) return;
+            }
+        }
+
+        template <class Out>
+        static void children(const Document::Node &aNode, Out aOut) {
+            for (Document::iterator i = aNode.begin(); i != aNode.end(); ++i)
+                if (!aOut(*i)) return;
+        }
+
+        /*
+        ** Path
+        */
+        Path::Path()
+            : iValid(true)
+        {
+        }
+
+        Path::Path(const std::string &aPointer)
+            : iValid(aPointer.empty() || aPointer[0] == '/')
+        {
+            size_t position = 0;
+            while (iValid && position < aPointer.size()) {
+                size_t next = aPointer.find('/', position + 1);
+                if (next == string::npos)
+                    next = aPointer.size();
+
+                Segment segment;
+                segment.index = string::npos;
+                segment.wildcard = false;
+
+                // Unescape ~1 -> '/', ~0 -> '~'
+                for (size_t n = position + 1; n < next; ++n) {
+                    char c = aPointer[n];
+                    if (c == '~') {
+                        char e = (n + 1 < next) ? aPointer[++n] : 0;
+                        if (e != '0' && e != '1') {
+                            iValid = false;
+                            break;
+                        }
+                        c = (e == '0') ? '~' : '/';
+                    }
+                    segment.name += c;
+                }
+
+                if (segment.name == "*") {
+                    segment.wildcard = true;
+                } else if (!segment.name.empty() && segment.name.size() < 20 &&
+                           (segment.name[0] != '0' || segment.name.size() == 1) &&
+                           segment.name.find_first_not_of("0123456789") == string::npos) {
+                    segment.index = (size_t)strtoull(segment.name.c_str(), nullptr, 10);
+                }
+                iSegments.push_back(segment);
+                position = next;
+            }
+            if (!iValid)
+                iSegments.clear();
+        }
+
+        template <class N>
+        bool Path::first(const N &aNode, size_t aSegment, N &aResult) const {
+            N node = aNode;
+            for (; aSegment < iSegments.size(); ++aSegment) {
+                const Segment &segment = iSegments[aSegment];
+                if (segment.wildcard) {
+                    size_t next = aSegment + 1;
+                    bool found = false;
+                    children(node, [this, next, &found, &aResult](const N &aChild) {
+                            found = first(aChild, next, aResult);
+                            return !found;
+                        });
+                    return found;
+                }
+                node = child(node, segment.name, segment.index);
+                if (!matched(node))
+                    return false;
+            }
+            aResult = node;
+            return true;
+        }
+
+        template <class N, class Out>
+        void Path::collect(const N &aNode, size_t aSegment, Out &aOut) const {
+            N node = aNode;
+            for (; aSegment < iSegments.size(); ++aSegment) {
+                const Segment &segment = iSegments[aSegment];
+                if (segment.wildcard) {
+                    size_t next = aSegment + 1;
+                    children(node, [this, next, &aOut](const N &aChild) {
+                            collect(aChild, next, aOut);
+                            return true;
+                        });
+                    return;
+                }
+                node = child(node, segment.name, segment.index);
+                if (!matched(node))
+                    return;
+            }
+            append(node, aOut);
+        }
+
+        const Value* Path::find(const Value &aRoot) const {
+            const Value *result = nullptr;
+            if (iValid)
+                first(&aRoot, 0, result);
+            return result;
+        }
+
+        Document::Node Path::find(const Document::Node &aRoot) const {
+            Document::Node result;
+            if (iValid && aRoot.valid())
+                first(aRoot, 0, result);
+            return result;
+        }
+
+        size_t Path::select(const Value &aRoot, std::vector<const Value*> &aOut) const {
+            size_t count = aOut.size();
+            if (iValid)
+                collect(&aRoot, 0, aOut);
+            return aOut.size() - count;
+        }
+
+        size_t Path::select(const Document::Node &aRoot, std::vector<Document::Node> &aOut) const {
+            size_t count = aOut.size();
+            if (iValid && aRoot.valid())
+                collect(aRoot, 0, aOut);
+            return aOut.size() - count;
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
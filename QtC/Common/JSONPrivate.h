@@ -0,0 +1,224 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONPrivate.h
+** Comment:    JSON scanning primitives shared by Reader and Document.
+*/
+
+#ifndef QTC_COMMON_JSON_PRIVATE_H
+#define QTC_COMMON_JSON_PRIVATE_H
+
+#include <string>
+
+namespace QtC {
+
+    namespace JSON {
+
+        /* Vectorized scanners (JSONScan.cpp), each returns end if
+           nothing is found. */
+        const char *findStringSpecial(const char *p, const char *end);  // '"', '\\', control or non-ASCII
+        const char *findQuoteEscapeOrControl(const char *p, const char *end);
+        const char *findNonWhitespace(const char *p, const char *end);
+
+        /* Returns nullptr if [p, end) is valid UTF-8, else the first bad byte. */
+        const char *validateUTF8(const char *p, const char *end);
+
+        inline bool isWhitespace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        inline const char *skipWhitespace(const char *p, const char *end) {
+            // Most gaps are empty or a single character.
+            if (p == end || !isWhitespace(*p))
+                return p;
+            if (++p == end || !isWhitespace(*p))
+                return p;
+            return findNonWhitespace(p + 1, end);
+        }
+
+        inline int hexValue(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        inline void appendUTF8(std::string &aBuffer, unsigned int aCodePoint) {
+            if (aCodePoint < 0x80) {
+                aBuffer += (char)aCodePoint;
+            } else if (aCodePoint < 0x800) {
+                aBuffer += (char)(0xc0 | (aCodePoint >> 6));
+                aBuffer += (char)(0x80 | (aCodePoint & 0x3f));
+            } else if (aCodePoint < 0x10000) {
+                aBuffer += (char)(0xe0 | (aCodePoint >> 12));
+                aBuffer += (char)(0x80 | ((aCodePoint >> 6) & 0x3f));
+                aBuffer += (char)(0x80 | (aCodePoint & 0x3f));
+            } else {
+                aBuffer += (char)(0xf0 | (aCodePoint >> 18));
+                aBuffer += (char)(0x80 | ((aCodePoint >> 12) & 0x3f));
+                aBuffer += (char)(0x80 | ((aCodePoint >> 6) & 0x3f));
+                aBuffer += (char)(0x80 | (aCodePoint & 0x3f));
+            }
+        }
+
+        /* Four hex digits at p, -1 if not valid. */
+        inline long readHex4(const char *p) {
+            long value = 0;
+            for (int n = 0; n < 4; ++n) {
+                int h = hexValue(p[n]);
+                if (h < 0)
+                    return -1;
+                value = (value << 4) | h;
+            }
+            return value;
+        }
+
+        /* Decodes the escape sequence following a backslash and advances p
+           past it. A \uD800-\uDBFF escape must be followed by a low
+           surrogate escape, the pair gives one code point. Returns the
+           code point, or -1 with p at the offending character. */
+        inline long readEscape(const char *&p, const char *end) {
+            if (p == end)
+                return -1;
+            switch (*p++) {
+            case '"':  return '"';
+            case '\\': return '\\';
+            case '/':  return '/';
+            case 'b':  return '\b';
+            case 'f':  return '\f';
+            case 'n':  return '\n';
+            case 'r':  return '\r';
+            case 't':  return '\t';
+            case 'u': {
+                long codePoint;
+                if (end - p < 4 || (codePoint = readHex4(p)) < 0)
+                    return -1;
+                if (codePoint >= 0xdc00 && codePoint <= 0xdfff) {
+                    // Low surrogate without a high one.
+                    p -= 2;
+                    return -1;
+                }
+                p += 4;
+                if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+                    long low;
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u' ||
+                        (low = readHex4(p + 2)) < 0xdc00 || low > 0xdfff)
+                        return -1;
+                    p += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                }
+                return codePoint;
+            }
+            default:
+                --p;
+                return -1;
+            }
+        }
+
+        /* scanString() picking up from p inside a string, aEscaped and
+           aNonASCII carry over from the part already scanned. When the
+           string is cut, returns end with aResume where scanning can
+           start again, which is never inside an escape. */
+        inline const char *resumeString(const char *p, const char *end, bool &aEscaped,
+                                        const char *&aNonASCII, const char *&aResume) {
+            while (true) {
+                p = aNonASCII ? findQuoteEscapeOrControl(p, end) : findStringSpecial(p, end);
+                if (p == end) {
+                    aResume = end;
+                    return end;
+                }
+                if (*p == '"')
+                    return p;
+                if (*p == '\\') {
+                    aEscaped = true;
+                    if (++p == end) {
+                        aResume = p - 1;
+                        return end;
+                    }
+                } else if ((unsigned char)*p < 0x20) {
+                    return p;
+                } else {
+                    aNonASCII = p;
+                }
+                ++p;
+            }
+        }
+
+        /* Finds the closing quote of a string, p is just after the opening
+           quote. Returns end if the string is not terminated, or the
+           position of an unescaped control character. aNonASCII is the
+           first byte >= 0x80, the caller validates UTF-8 from there. */
+        inline const char *scanString(const char *p, const char *end, bool &aEscaped, const char *&aNonASCII) {
+            const char *resume;
+            aEscaped = false;
+            aNonASCII = nullptr;
+            return resumeString(p, end, aEscaped, aNonASCII, resume);
+        }
+
+        inline bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        /* Validates a number token. Returns its end, or nullptr with the
+           offending position in aError (== end if input ran out). */
+        inline const char *scanNumber(const char *p, const char *end, bool &aIntegral, const char *&aError) {
+            aIntegral = true;
+            if (p != end && *p == '-')
+                ++p;
+            if (p == end || !isDigit(*p)) {
+                aError = p;
+                return nullptr;
+            }
+            if (*p == '0') {
+                ++p;
+            } else {
+                while (p != end && isDigit(*p))
+                    ++p;
+            }
+            if (p != end && *p == '.') {
+                aIntegral = false;
+                if (++p == end || !isDigit(*p)) {
+                    aError = p;
+                    return nullptr;
+                }
+                while (p != end && isDigit(*p))
+                    ++p;
+            }
+            if (p != end && (*p == 'e' || *p == 'E')) {
+                aIntegral = false;
+                if (++p != end && (*p == '+' || *p == '-'))
+                    ++p;
+                if (p == end || !isDigit(*p)) {
+                    aError = p;
+                    return nullptr;
+                }
+                while (p != end && isDigit(*p))
+                    ++p;
+            }
+            return p;
+        }
+
+        /* Decodes the escaped string content [aBegin, aEnd) into aOut.
+           Returns nullptr, or the position of an invalid escape. */
+        const char *unescape(const char *aBegin, const char *aEnd, std::string &aOut);
+
+        /* A converted number token. */
+        struct Number {
+            enum Type {
+                Integer,    // fits long long
+                Unsigned,   // above the long long range, fits unsigned long long
+                Float
+            };
+            Type type;
+            long long int integer;
+            unsigned long long int uinteger;
+            double real;
+        };
+
+        /* Converts a validated number token (JSONNumber.cpp), exactly and
+           independent of the C locale. */
+        Number toNumber(const char *aBegin, const char *aEnd, bool aIntegral);
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
+
+#endif /* QTC_COMMON_JSON_PRIVATE_H */
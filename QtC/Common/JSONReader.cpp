@@ -0,0 +1,503 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONReader.cpp
+*/
+
+#include <cstring>
+#include <stdexcept>
+
+#include "QtC/Common/JSON.h"
+#include "QtC/Common/JSONPrivate.h"
+#include "QtC/Common/MappedFile.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        /*
+        ** Handler - default implementation ignores everything.
+        */
+        Handler::~Handler() { }
+        bool Handler::null() { return true; }
+        bool Handler::boolean(bool) { return true; }
+        bool Handler::integer(long long int) { return true; }
+        bool Handler::unsignedInteger(unsigned long long int aValue) { return number((double)aValue); }
+        bool Handler::number(double) { return true; }
+        bool Handler::string(const char *, size_t) { return true; }
+        bool Handler::bytes(const char *aData, size_t aLength) { return string(aData, aLength); }
+        bool Handler::beginObject() { return true; }
+        bool Handler::key(const char *, size_t) { return true; }
+        bool Handler::endObject() { return true; }
+        bool Handler::beginArray() { return true; }
+        bool Handler::endArray() { return true; }
+
+        /*
+        ** Scanning helpers shared with Document.
+        */
+        const char *unescape(const char *aBegin, const char *aEnd, std::string &aOut) {
+            const char *p = aBegin;
+
+            while (p != aEnd) {
+                // Copy the run up to the next escape in one go.
+                const char *run = p;
+                p = findQuoteEscapeOrControl(p, aEnd);
+                aOut.append(run, p - run);
+                if (p == aEnd)
+                    break;
+                if (*p != '\\')
+                    return p;
+
+                long codePoint = readEscape(++p, aEnd);
+                if (codePoint < 0)
+                    return p;
+                appendUTF8(aOut, (unsigned int)codePoint);
+            }
+            return nullptr;
+        }
+
+        /*
+        ** Reader
+        */
+        Reader::Reader()
+            : iBegin(nullptr), iIncomplete(nullptr), iFinal(true), iOffset(0),
+              iResume(0), iResumeEscaped(false), iResumeNonASCII(0),
+              iState(StateValue), iStatus(Complete), iErrorOffset(0)
+        {
+        }
+
+        void Reader::reset() {
+            iBegin = nullptr;
+            iIncomplete = nullptr;
+            iFinal = false;
+            iOffset = 0;
+            iPending.clear();
+            iResume = 0;
+            iState = StateValue;
+            iStack.clear();
+            iStatus = Incomplete;
+            iErrorOffset = 0;
+        }
+
+        Reader::Status Reader::parse(const std::string &aText, Handler &aHandler) {
+            return parse(aText.data(), aText.size(), aHandler);
+        }
+
+        Reader::Status Reader::parse(const char *aData, size_t aLength, Handler &aHandler) {
+            reset();
+            iFinal = true;
+            return run(aData, aLength, aHandler);
+        }
+
+        Reader::Status Reader::feed(const char *aData, size_t aLength, Handler &aHandler) {
+            if (iStatus != Incomplete && iStatus != Complete)
+                return iStatus;
+
+            if (iPending.empty()) {
+                run(aData, aLength, aHandler);
+                if (iIncomplete)
+                    iPending.assign(iIncomplete, aData + aLength - iIncomplete);
+            } else {
+                // Resume the cut token, the carried over bytes come first.
+                iOffset -= iPending.size();
+                iPending.append(aData, aLength);
+                run(iPending.data(), iPending.size(), aHandler);
+                if (iIncomplete)
+                    iPending.erase(0, iIncomplete - iPending.data());
+                else
+                    iPending.clear();
+            }
+            return iStatus;
+        }
+
+        Reader::Status Reader::finish(Handler &aHandler) {
+            if (iStatus != Incomplete && iStatus != Complete)
+                return iStatus;
+
+            iFinal = true;
+            std::string pending;
+            pending.swap(iPending);
+            iOffset -= pending.size();
+            return run(pending.data(), pending.size(), aHandler);
+        }
+
+        Reader::Status Reader::run(const char *aData, size_t aLength, Handler &aHandler) {
+            const char *p = aData;
+            const char *end = aData + aLength;
+
+            iBegin = aData;
+            iIncomplete = nullptr;
+            iStatus = Incomplete;
+
+            while (p) {
+                p = skipWhitespace(p, end);
+                if (iState == StateDone) {
+                    if (p != end)
+                        fail(p);
+                    else
+                        iStatus = Complete;
+                    break;
+                }
+                if (p == end) {
+                    if (iFinal)
+                        fail(p);
+                    break;
+                }
+
+                switch (iState) {
+                case StateValue:
+                    p = value(p, end, aHandler);
+                    break;
+
+                case StateArrayFirst:
+                    if (*p != ']') {
+                        p = value(p, end, aHandler);
+                        break;
+                    }
+                    /* fall through */
+                case StateArrayNext:
+                    if (*p == ']') {
+                        iStack.pop_back();
+                        p = aHandler.endArray() ? endValue(p + 1) : nullptr;
+                    } else if (*p == ',' && iState == StateArrayNext) {
+                        iState = StateValue;
+                        ++p;
+                    } else {
+                        p = fail(p);
+                    }
+                    break;
+
+                case StateObjectFirst:
+                    if (*p == '}') {
+                        iStack.pop_back();
+                        p = aHandler.endObject() ? endValue(p + 1) : nullptr;
+                        break;
+                    }
+                    /* fall through */
+                case StateObjectKey:
+                    if (*p == '"') {
+                        p = string(p, end, aHandler, true);
+                        if (p)
+                            iState = StateObjectColon;
+                    } else {
+                        p = fail(p);
+                    }
+                    break;
+
+                case StateObjectColon:
+                    if (*p == ':') {
+                        iState = StateValue;
+                        ++p;
+                    } else {
+                        p = fail(p);
+                    }
+                    break;
+
+                case StateObjectNext:
+                    if (*p == '}') {
+                        iStack.pop_back();
+                        p = aHandler.endObject() ? endValue(p + 1) : nullptr;
+                    } else if (*p == ',') {
+                        iState = StateObjectKey;
+                        ++p;
+                    } else {
+                        p = fail(p);
+                    }
+                    break;
+
+                case StateDone:
+                    break;
+                }
+            }
+
+            if (!p && iStatus == Incomplete && !iIncomplete)
+                iStatus = Aborted;
+            iOffset += aLength;
+            return iStatus;
+        }
+
+        const char *Reader::fail(const char *p) {
+            iStatus = SyntaxError;
+            iErrorOffset = iOffset + (p - iBegin);
+            return nullptr;
+        }
+
+        const char *Reader::more(const char *p) {
+            if (iFinal)
+                return fail(p);
+            iIncomplete = p;
+            return nullptr;
+        }
+
+        const char *Reader::endValue(const char *p) {
+            if (iStack.empty())
+                iState = StateDone;
+            else if (iStack.back() == '[')
+                iState = StateArrayNext;
+            else
+                iState = StateObjectNext;
+            return p;
+        }
+
+        const char *Reader::value(const char *p, const char *end, Handler &aHandler) {
+            switch (*p) {
+            case '{':
+                iStack.push_back('{');
+                iState = StateObjectFirst;
+                return aHandler.beginObject() ? p + 1 : nullptr;
+            case '[':
+                iStack.push_back('[');
+                iState = StateArrayFirst;
+                return aHandler.beginArray() ? p + 1 : nullptr;
+            case '"':
+                p = string(p, end, aHandler, false);
+                return p ? endValue(p) : nullptr;
+            case 't': case 'f': case 'n':
+                p = literal(p, end, aHandler);
+                return p ? endValue(p) : nullptr;
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                p = number(p, end, aHandler);
+                return p ? endValue(p) : nullptr;
+            default:
+                return fail(p);
+            }
+        }
+
+        const char *Reader::string(const char *p, const char *end, Handler &aHandler, bool aKey) {
+            const char *token = p;
+            const char *begin = ++p;
+            const char *nonASCII = nullptr;
+            const char *resume;
+            bool escaped = false;
+
+            if (iResume && token == iBegin) {
+                // The carried over token, skip the part scanned before.
+                p = token + iResume;
+                escaped = iResumeEscaped;
+                if (iResumeNonASCII)
+                    nonASCII = token + iResumeNonASCII;
+            }
+            iResume = 0;
+
+            p = resumeString(p, end, escaped, nonASCII, resume);
+            if (p == end) {
+                if (!iFinal) {
+                    iResume = resume - token;
+                    iResumeEscaped = escaped;
+                    iResumeNonASCII = nonASCII ? nonASCII - token : 0;
+                }
+                return more(token);
+            }
+            if (*p != '"')
+                return fail(p);
+            if (nonASCII) {
+                const char *error = validateUTF8(nonASCII, p);
+                if (error)
+                    return fail(error);
+            }
+
+            if (!escaped) {
+                // No escapes, hand out the input directly.
+                if (!(aKey ? aHandler.key(begin, p - begin) : aHandler.string(begin, p - begin)))
+                    return nullptr;
+                return p + 1;
+            }
+
+            iScratch.clear();
+            const char *error = unescape(begin, p, iScratch);
+            if (error)
+                return fail(error);
+
+            if (!(aKey ? aHandler.key(iScratch.data(), iScratch.size())
+                       : aHandler.string(iScratch.data(), iScratch.size())))
+                return nullptr;
+            return p + 1;
+        }
+
+        const char *Reader::number(const char *p, const char *end, Handler &aHandler) {
+            const char *begin = p;
+            const char *error = nullptr;
+            bool integral;
+
+            p = scanNumber(p, end, integral, error);
+            if (p == nullptr) {
+                // Cut by the chunk end, or malformed.
+                if (error == end && !iFinal)
+                    return more(begin);
+                return fail(error);
+            }
+            if (p == end && !iFinal) {
+                // The number may continue in the next chunk.
+                return more(begin);
+            }
+
+            Number number = toNumber(begin, p, integral);
+            bool go;
+            switch (number.type) {
+            case Number::Integer:  go = aHandler.integer(number.integer); break;
+            case Number::Unsigned: go = aHandler.unsignedInteger(number.uinteger); break;
+            default:               go = aHandler.number(number.real); break;
+            }
+            return go ? p : nullptr;
+        }
+
+        const char *Reader::literal(const char *p, const char *end, Handler &aHandler) {
+            size_t left = end - p;
+            bool go;
+
+            if (left < 5) {
+                // Possibly cut by the chunk end.
+                const char *literals[] = { "true", "false", "null" };
+                for (int n = 0; n < 3; ++n) {
+                    size_t length = strlen(literals[n]);
+                    if (left < length && memcmp(p, literals[n], left) == 0)
+                        return more(p);
+                }
+            }
+
+            if (left >= 4 && memcmp(p, "true", 4) == 0) {
+                go = aHandler.boolean(true);
+                p += 4;
+            } else if (left >= 5 && memcmp(p, "false", 5) == 0) {
+                go = aHandler.boolean(false);
+                p += 5;
+            } else if (left >= 4 && memcmp(p, "null", 4) == 0) {
+                go = aHandler.null();
+                p += 4;
+            } else {
+                return fail(p);
+            }
+            return go ? p : nullptr;
+        }
+
+        /*
+        ** ValueBuilder
+        */
+        ValueBuilder::ValueBuilder()
+            : iKeys(&iOwnKeys), iDepth(0)
+        {
+        }
+
+        ValueBuilder::ValueBuilder(KeyTable &aKeys)
+            : iKeys(&aKeys), iDepth(0)
+        {
+        }
+
+        void ValueBuilder::reset() {
+            // Frames left open by a failed parse still hold members.
+            for (size_t n = 0; n < iDepth; ++n) {
+                iStack[n].object = Object();
+                iStack[n].array = Array();
+                iStack[n].key = Key();
+            }
+            iDepth = 0;
+            iValue = Value();
+        }
+
+        bool ValueBuilder::add(Value &&aValue) {
+            if (iDepth == 0) {
+                iValue = move(aValue);
+                return true;
+            }
+            Frame &frame = iStack[iDepth - 1];
+            if (frame.isObject)
+                frame.object.add(frame.key, move(aValue));
+            else
+                frame.array.push_back(move(aValue));
+            return true;
+        }
+
+        bool ValueBuilder::null() {
+            return add(Value());
+        }
+
+        bool ValueBuilder::boolean(bool aValue) {
+            return add(Value(aValue));
+        }
+
+        bool ValueBuilder::integer(long long int aValue) {
+            return add(Value(aValue));
+        }
+
+        bool ValueBuilder::unsignedInteger(unsigned long long int aValue) {
+            return add(Value(aValue));
+        }
+
+        bool ValueBuilder::number(double aValue) {
+            return add(Value(aValue));
+        }
+
+        bool ValueBuilder::string(const char *aData, size_t aLength) {
+            return add(Value(std::string(aData, aLength)));
+        }
+
+        bool ValueBuilder::beginObject() {
+            // Frames are reused, their containers are left empty by the moves.
+            if (iDepth == iStack.size())
+                iStack.push_back(Frame());
+            iStack[iDepth++].isObject = true;
+            return true;
+        }
+
+        bool ValueBuilder::key(const char *aData, size_t aLength) {
+            iStack[iDepth - 1].key = iKeys->intern(aData, aLength);
+            return true;
+        }
+
+        bool ValueBuilder::endObject() {
+            Frame &frame = iStack[--iDepth];
+            Value value(move(frame.object));
+            frame.object = Object();
+            return add(move(value));
+        }
+
+        bool ValueBuilder::beginArray() {
+            if (iDepth == iStack.size())
+                iStack.push_back(Frame());
+            iStack[iDepth++].isObject = false;
+            return true;
+        }
+
+        bool ValueBuilder::endArray() {
+            Frame &frame = iStack[--iDepth];
+            Value value(move(frame.array));
+            frame.array = Array();
+            return add(move(value));
+        }
+
+        /*
+        ** Parsing into a Value tree
+        */
+        Value parseString(const std::string &aString, KeyTable &aKeys) {
+            Reader reader;
+            ValueBuilder builder(aKeys);
+
+            if (reader.parse(aString, builder) != Reader::Complete)
+                throw std::runtime_error("Error parsing file: JSON syntax.");
+            return move(builder.value());
+        }
+
+        Value parseString(const std::string &aString) {
+            KeyTable keys;
+            return parseString(aString, keys);
+        }
+
+        Value parseFile(const char *aFilename) {
+            // Parsed straight from the mapping, no read buffer.
+            MappedFile file;
+            if (!file.open(aFilename, MappedFile::Sequential))
+                throw std::runtime_error("Impossible to open file.");
+
+            Reader reader;
+            KeyTable keys;
+            ValueBuilder builder(keys);
+            if (reader.parse(file.data(), file.size(), builder) != Reader::Complete)
+                throw std::runtime_error("Error parsing file: JSON syntax.");
+            return move(builder.value());
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
@@ -0,0 +1,303 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONScan.cpp
+** Comment:    Vectorized JSON scanners with run time dispatch.
+*/
+
+#include <stdint.h>
+#include <cstring>
+
+#include "QtC/Common/CPU.h"
+#include "QtC/Common/JSONPrivate.h"
+
+#if defined(QTC_CPU_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(QTC_CPU_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace QtC {
+
+    namespace JSON {
+
+        typedef const char *(*Scanner)(const char *p, const char *end);
+
+        static inline unsigned int firstBit(unsigned int aMask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, aMask);
+            return index;
+#else
+            return __builtin_ctz(aMask);
+#endif
+        }
+
+        /* Length of the UTF-8 sequence at p, 0 if it is invalid (overlong,
+           surrogate, beyond U+10FFFF or truncated). */
+        static inline size_t sequenceUTF8(const unsigned char *p, const unsigned char *end) {
+            unsigned int c = p[0];
+            size_t left = end - p;
+
+            if (c < 0x80)
+                return 1;
+            if (c < 0xc2)
+                return 0;
+            if (c < 0xe0)
+                return (left >= 2 && (p[1] & 0xc0) == 0x80) ? 2 : 0;
+            if (c < 0xf0) {
+                if (left < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80)
+                    return 0;
+                if ((c == 0xe0 && p[1] < 0xa0) || (c == 0xed && p[1] >= 0xa0))
+                    return 0;
+                return 3;
+            }
+            if (c < 0xf5) {
+                if (left < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80)
+                    return 0;
+                if ((c == 0xf0 && p[1] < 0x90) || (c == 0xf4 && p[1] >= 0x90))
+                    return 0;
+                return 4;
+            }
+            return 0;
+        }
+
+        /*
+        ** Scalar
+        */
+        static const char *findStringSpecialScalar(const char *p, const char *end) {
+            while (p != end && *p != '"' && *p != '\\' &&
+                   (unsigned char)*p >= 0x20 && (unsigned char)*p < 0x80)
+                ++p;
+            return p;
+        }
+
+        static const char *findQuoteEscapeOrControlScalar(const char *p, const char *end) {
+            while (p != end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20)
+                ++p;
+            return p;
+        }
+
+        static const char *findNonWhitespaceScalar(const char *p, const char *end) {
+            while (p != end && isWhitespace(*p))
+                ++p;
+            return p;
+        }
+
+        static const char *validateUTF8Scalar(const char *p, const char *end) {
+            while (p != end) {
+                uint64_t block;
+                if (end - p >= 8) {
+                    memcpy(&block, p, 8);
+                    if ((block & 0x8080808080808080ULL) == 0) {
+                        p += 8;
+                        continue;
+                    }
+                }
+                size_t length = sequenceUTF8((const unsigned char *)p, (const unsigned char *)end);
+                if (length == 0)
+                    return p;
+                p += length;
+            }
+            return nullptr;
+        }
+
+#if defined(QTC_CPU_SSE2)
+        /*
+        ** SSE2, 16 bytes at a time
+        */
+        static const char *findStringSpecialSSE2(const char *p, const char *end) {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i escape = _mm_set1_epi8('\\');
+
+            const __m128i space = _mm_set1_epi8(' ');
+
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, escape));
+                // Signed compare: below ' ' and every byte >= 0x80.
+                unsigned int mask = _mm_movemask_epi8(_mm_or_si128(special, _mm_cmplt_epi8(v, space)));
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findStringSpecialScalar(p, end);
+        }
+
+        static const char *findQuoteEscapeOrControlSSE2(const char *p, const char *end) {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i escape = _mm_set1_epi8('\\');
+            const __m128i high = _mm_set1_epi8((char)0xe0);
+            const __m128i zero = _mm_setzero_si128();
+
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, escape));
+                __m128i control = _mm_cmpeq_epi8(_mm_and_si128(v, high), zero);
+                unsigned int mask = _mm_movemask_epi8(_mm_or_si128(special, control));
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findQuoteEscapeOrControlScalar(p, end);
+        }
+
+        static const char *findNonWhitespaceSSE2(const char *p, const char *end) {
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i newline = _mm_set1_epi8('\n');
+            const __m128i ret = _mm_set1_epi8('\r');
+            const __m128i tab = _mm_set1_epi8('\t');
+
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, newline)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(v, ret), _mm_cmpeq_epi8(v, tab)));
+                unsigned int mask = ~_mm_movemask_epi8(ws) & 0xffff;
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findNonWhitespaceScalar(p, end);
+        }
+
+        static const char *validateUTF8SSE2(const char *p, const char *end) {
+            while (end - p >= 16) {
+                unsigned int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p));
+                if (mask == 0) {
+                    p += 16;
+                    continue;
+                }
+                p += firstBit(mask);
+                size_t length = sequenceUTF8((const unsigned char *)p, (const unsigned char *)end);
+                if (length == 0)
+                    return p;
+                p += length;
+            }
+            return validateUTF8Scalar(p, end);
+        }
+#endif /* QTC_CPU_SSE2 */
+
+#if defined(QTC_CPU_DISPATCH)
+        /*
+        ** AVX2, 32 bytes at a time
+        */
+        QTC_TARGET_AVX2
+        static const char *findStringSpecialAVX2(const char *p, const char *end) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i escape = _mm256_set1_epi8('\\');
+
+            const __m256i space = _mm256_set1_epi8(' ');
+
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i *)p);
+                __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, escape));
+                __m256i other = _mm256_cmpgt_epi8(space, v);
+                unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(special, other));
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findStringSpecialSSE2(p, end);
+        }
+
+        QTC_TARGET_AVX2
+        static const char *findQuoteEscapeOrControlAVX2(const char *p, const char *end) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i escape = _mm256_set1_epi8('\\');
+            const __m256i high = _mm256_set1_epi8((char)0xe0);
+            const __m256i zero = _mm256_setzero_si256();
+
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i *)p);
+                __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, escape));
+                __m256i control = _mm256_cmpeq_epi8(_mm256_and_si256(v, high), zero);
+                unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(special, control));
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findQuoteEscapeOrControlSSE2(p, end);
+        }
+
+        QTC_TARGET_AVX2
+        static const char *findNonWhitespaceAVX2(const char *p, const char *end) {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i newline = _mm256_set1_epi8('\n');
+            const __m256i ret = _mm256_set1_epi8('\r');
+            const __m256i tab = _mm256_set1_epi8('\t');
+
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i *)p);
+                __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, newline)),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(v, ret), _mm256_cmpeq_epi8(v, tab)));
+                unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(ws);
+                if (mask)
+                    return p + firstBit(mask);
+            }
+            return findNonWhitespaceSSE2(p, end);
+        }
+
+        QTC_TARGET_AVX2
+        static const char *validateUTF8AVX2(const char *p, const char *end) {
+            while (end - p >= 32) {
+                unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)p));
+                if (mask == 0) {
+                    p += 32;
+                    continue;
+                }
+                p += firstBit(mask);
+                size_t length = sequenceUTF8((const unsigned char *)p, (const unsigned char *)end);
+                if (length == 0)
+                    return p;
+                p += length;
+            }
+            return validateUTF8SSE2(p, end);
+        }
+#endif /* QTC_CPU_DISPATCH */
+
+        /*
+        ** Dispatch, resolved on first use.
+        */
+        struct Scanners {
+            Scanner stringSpecial;
+            Scanner quoteEscapeOrControl;
+            Scanner nonWhitespace;
+            Scanner utf8;
+        };
+
+        static Scanners selectScanners() {
+#if defined(QTC_CPU_DISPATCH)
+            if (CPU::hasAVX2()) {
+                Scanners s = { findStringSpecialAVX2, findQuoteEscapeOrControlAVX2,
+                               findNonWhitespaceAVX2, validateUTF8AVX2 };
+                return s;
+            }
+#endif
+#if defined(QTC_CPU_SSE2)
+            Scanners s = { findStringSpecialSSE2, findQuoteEscapeOrControlSSE2,
+                           findNonWhitespaceSSE2, validateUTF8SSE2 };
+#else
+            Scanners s = { findStringSpecialScalar, findQuoteEscapeOrControlScalar,
+                           findNonWhitespaceScalar, validateUTF8Scalar };
+#endif
+            return s;
+        }
+
+        static const Scanners& scanners() {
+            static const Scanners s = selectScanners();
+            return s;
+        }
+
+        const char *findStringSpecial(const char *p, const char *end) {
+            return scanners().stringSpecial(p, end);
+        }
+
+        const char *findQuoteEscapeOrControl(const char *p, const char *end) {
+            return scanners().quoteEscapeOrControl(p, end);
+        }
+
+        const char *findNonWhitespace(const char *p, const char *end) {
+            return scanners().nonWhitespace(p, end);
+        }
+
+        const char *validateUTF8(const char *p, const char *end) {
+            return scanners().utf8(p, end);
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
@@ -0,0 +1,270 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/JSONWriter.cpp
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "QtC/Common/JSON.h"
+
+using namespace std;
+
+namespace QtC {
+
+    namespace JSON {
+
+        /*
+        ** Escape table: 0 = copy as is, 'u' = \u00XX, otherwise the
+        ** character following the backslash.
+        */
+        static const char gEscape[256] = {
+            'u','u','u','u','u','u','u','u','b','t','n','u','f','r','u','u',
+            'u','u','u','u','u','u','u','u','u','u','u','u','u','u','u','u',
+            0,  0,  '"',0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+            0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+            0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+            0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  '\\',0, 0,  0
+            /* 0x60 .. 0xff: 0 */
+        };
+
+        static const char gHexDigits[] = "0123456789abcdef";
+
+        static const char gDigitPairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        static void appendEscaped(string &aBuffer, const char *aData, size_t aLength) {
+            const unsigned char *p = (const unsigned char *)aData;
+            const unsigned char *end = p + aLength;
+            const unsigned char *run = p;
+
+            aBuffer += '"';
+            while (p != end) {
+                char e = gEscape[*p];
+                if (e == 0) {
+                    ++p;
+                    continue;
+                }
+                aBuffer.append((const char *)run, p - run);
+                aBuffer += '\\';
+                if (e == 'u') {
+                    char u[5] = { 'u', '0', '0', gHexDigits[*p >> 4], gHexDigits[*p & 0xf] };
+                    aBuffer.append(u, 5);
+                } else {
+                    aBuffer += e;
+                }
+                run = ++p;
+            }
+            aBuffer.append((const char *)run, p - run);
+            aBuffer += '"';
+        }
+
+        static void appendUnsigned(string &aBuffer, unsigned long long int aValue) {
+            char buf[20];
+            char *p = buf + sizeof(buf);
+
+            while (aValue >= 100) {
+                unsigned int i = (unsigned int)(aValue % 100) * 2;
+                aValue /= 100;
+                *--p = gDigitPairs[i + 1];
+                *--p = gDigitPairs[i];
+            }
+            if (aValue >= 10) {
+                unsigned int i = (unsigned int)aValue * 2;
+                *--p = gDigitPairs[i + 1];
+                *--p = gDigitPairs[i];
+            } else {
+                *--p = (char)('0' + aValue);
+            }
+            aBuffer.append(p, buf + sizeof(buf) - p);
+        }
+
+        static void appendDouble(string &aBuffer, double aValue) {
+            if (std::isnan(aValue) || std::isinf(aValue)) {
+                // Not representable in JSON
+                aBuffer.append("null", 4);
+                return;
+            }
+
+            // Shortest of 15..17 significant digits that reads back exactly.
+            char buf[32];
+            int length = 0;
+            for (int precision = 15; precision <= 17; ++precision) {
+                length = snprintf(buf, sizeof(buf), "%.*g", precision, aValue);
+                if (strtod(buf, nullptr) == aValue)
+                    break;
+            }
+
+            // Locale independent output, keep the value a float on re-read.
+            bool fractional = false;
+            for (int n = 0; n < length; ++n) {
+                if (buf[n] == ',') buf[n] = '.';
+                if (buf[n] == '.' || buf[n] == 'e') fractional = true;
+            }
+            aBuffer.append(buf, length);
+            if (!fractional)
+                aBuffer.append(".0", 2);
+        }
+
+        Writer::Writer(Format aFormat)
+            : iFormat(aFormat), iAfterKey(false)
+        {
+        }
+
+        void Writer::clear() {
+            iBuffer.clear();
+            iFirst.clear();
+            iAfterKey = false;
+        }
+
+        void Writer::newline() {
+            iBuffer += '\n';
+            iBuffer.append(iFirst.size(), '\t');
+        }
+
+        void Writer::separator() {
+            if (iAfterKey) {
+                iAfterKey = false;
+                return;
+            }
+            if (iFirst.empty())
+                return;
+            if (iFirst.back()) {
+                iFirst.back() = false;
+            } else {
+                iBuffer += ',';
+            }
+            if (iFormat == Pretty)
+                newline();
+        }
+
+        void Writer::close(char aBracket) {
+            bool empty = iFirst.back();
+            iFirst.pop_back();
+            if (iFormat == Pretty && !empty)
+                newline();
+            iBuffer += aBracket;
+        }
+
+        Writer& Writer::beginObject() {
+            separator();
+            iBuffer += '{';
+            iFirst.push_back(true);
+            return *this;
+        }
+
+        Writer& Writer::endObject() {
+            close('}');
+            return *this;
+        }
+
+        Writer& Writer::beginArray() {
+            separator();
+            iBuffer += '[';
+            iFirst.push_back(true);
+            return *this;
+        }
+
+        Writer& Writer::endArray() {
+            close(']');
+            return *this;
+        }
+
+        Writer& Writer::key(const char *aData, size_t aLength) {
+            separator();
+            appendEscaped(iBuffer, aData, aLength);
+            if (iFormat == Pretty)
+                iBuffer.append(": ", 2);
+            else
+                iBuffer += ':';
+            iAfterKey = true;
+            return *this;
+        }
+
+        Writer& Writer::null() {
+            separator();
+            iBuffer.append("null", 4);
+            return *this;
+        }
+
+        Writer& Writer::boolean(bool aValue) {
+            separator();
+            if (aValue)
+                iBuffer.append("true", 4);
+            else
+                iBuffer.append("false", 5);
+            return *this;
+        }
+
+        Writer& Writer::integer(long long int aValue) {
+            separator();
+            if (aValue < 0) {
+                iBuffer += '-';
+                appendUnsigned(iBuffer, 0ULL - (unsigned long long int)aValue);
+            } else {
+                appendUnsigned(iBuffer, (unsigned long long int)aValue);
+            }
+            return *this;
+        }
+
+        Writer& Writer::unsignedInteger(unsigned long long int aValue) {
+            separator();
+            appendUnsigned(iBuffer, aValue);
+            return *this;
+        }
+
+        Writer& Writer::number(double aValue) {
+            separator();
+            appendDouble(iBuffer, aValue);
+            return *this;
+        }
+
+        Writer& Writer::string(const char *aData, size_t aLength) {
+            separator();
+            appendEscaped(iBuffer, aData, aLength);
+            return *this;
+        }
+
+        Writer& Writer::write(const Value &aValue) {
+            switch(aValue.type()) {
+            case INT:    return aValue.is_unsigned() ? unsignedInteger(aValue.as_uint())
+                                                 : integer(aValue.as_int());
+            case FLOAT:  return number(aValue.as_float());
+            case BOOL:   return boolean(aValue.as_bool());
+            case NIL:    return null();
+            case STRING: return string(aValue.string_ref());
+            case ARRAY:  return write(aValue.array_ref());
+            case OBJECT: return write(aValue.object_ref());
+            }
+            return *this;
+        }
+
+        Writer& Writer::write(const Object &aObject) {
+            beginObject();
+            for (Object::const_iterator i = aObject.begin(); i != aObject.end(); ++i) {
+                key(i->first.str());
+                write(i->second);
+            }
+            return endObject();
+        }
+
+        Writer& Writer::write(const Array &aArray) {
+            beginArray();
+            for (vector<Value>::const_iterator i = aArray.begin(); i != aArray.end(); ++i) {
+                write(*i);
+            }
+            return endArray();
+        }
+
+    } /* namespace JSON */
+
+} /* namespace QtC */
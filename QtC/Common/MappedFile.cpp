@@ -0,0 +1,137 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/MappedFile.cpp
+*/
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "QtC/Common/MappedFile.h"
+
+namespace QtC {
+
+    static const char gEmpty[1] = { 0 };
+
+    MappedFile::MappedFile()
+        : iData(nullptr), iSize(0), iMapped(false)
+#if defined(_WIN32)
+        , iFile(INVALID_HANDLE_VALUE), iMapping(nullptr)
+#endif
+    {
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+#if defined(_WIN32)
+    bool MappedFile::open(const char *aFilename, Access aAccess) {
+        close();
+
+        DWORD flags = (aAccess == Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        iFile = CreateFileA(aFilename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+        if (iFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(iFile, &size)) {
+            close();
+            return false;
+        }
+        if (size.QuadPart == 0) {
+            iData = gEmpty;
+            return true;
+        }
+
+        iMapping = CreateFileMappingA(iFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (iMapping == nullptr) {
+            close();
+            return false;
+        }
+        iData = (const char *)MapViewOfFile(iMapping, FILE_MAP_READ, 0, 0, 0);
+        if (iData == nullptr) {
+            close();
+            return false;
+        }
+        iSize = (size_t)size.QuadPart;
+        iMapped = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (iMapped)
+            UnmapViewOfFile(iData);
+        if (iMapping)
+            CloseHandle(iMapping);
+        if (iFile != INVALID_HANDLE_VALUE)
+            CloseHandle(iFile);
+        iData = nullptr;
+        iSize = 0;
+        iMapped = false;
+        iFile = INVALID_HANDLE_VALUE;
+        iMapping = nullptr;
+    }
+#else
+    bool MappedFile::open(const char *aFilename, Access aAccess) {
+        close();
+
+        int fd = ::open(aFilename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (!S_ISREG(status.st_mode) || status.st_size == 0) {
+            // Pipes, devices and procfs have no size to map, read them through.
+            char buffer[16384];
+            ssize_t length;
+            while ((length = ::read(fd, buffer, sizeof(buffer))) != 0) {
+                if (length < 0 && errno == EINTR)
+                    continue;
+                if (length < 0) {
+                    ::close(fd);
+                    iBuffer.clear();
+                    return false;
+                }
+                iBuffer.append(buffer, (size_t)length);
+            }
+            ::close(fd);
+            iData = iBuffer.empty() ? gEmpty : iBuffer.data();
+            iSize = iBuffer.size();
+            return true;
+        }
+
+        // The mapping stays valid after the descriptor is closed.
+        void *data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        madvise(data, (size_t)status.st_size, (aAccess == Sequential) ? MADV_SEQUENTIAL : MADV_WILLNEED);
+        iData = (const char *)data;
+        iSize = (size_t)status.st_size;
+        iMapped = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (iMapped)
+            munmap((void *)iData, iSize);
+        std::string().swap(iBuffer);
+        iData = nullptr;
+        iSize = 0;
+        iMapped = false;
+    }
+#endif
+
+} /* namespace QtC */
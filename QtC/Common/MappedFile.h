@@ -0,0 +1,50 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/MappedFile.h
+** Comment:    Read-only memory mapped file.
+*/
+
+#ifndef QTC_COMMON_MAPPED_FILE_H
+#define QTC_COMMON_MAPPED_FILE_H
+
+#include <stddef.h>
+
+#include <string>
+
+namespace QtC {
+
+    /** Maps a whole file read-only into memory. Files that cannot be
+        mapped, pipes and files of unknown size such as in /proc, are
+        read into a buffer instead. */
+    class MappedFile {
+    public:
+        enum Access {
+            Sequential,     // read once front to back
+            Random          // read repeatedly / out of order
+        };
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        bool open(const char *aFilename, Access aAccess = Sequential);
+        void close();
+
+        bool isOpen() const { return iData != nullptr; }
+        const char* data() const { return iData; }
+        size_t size() const { return iSize; }
+    private:
+        MappedFile(const MappedFile &);
+        MappedFile& operator=(const MappedFile &);
+    private:
+        const char *iData;
+        size_t iSize;
+        bool iMapped;           // false for an empty or read file
+        std::string iBuffer;    // contents of a file that is not mapped
+#if defined(_WIN32)
+        void *iFile;
+        void *iMapping;
+#endif
+    };
+
+} /* namespace QtC */
+
+#endif /* QTC_COMMON_MAPPED_FILE_H */
@@ -0,0 +1,62 @@
+/* -*- mode:c++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+** File:       QtC/Common/StringRef.h
+** Comment:    Non-owning view of a character range.
+*/
+
+#ifndef QTC_COMMON_STRINGREF_H
+#define QTC_COMMON_STRINGREF_H
+
+#include <stddef.h>
+#include <string.h>
+
+#include <string>
+#include <iostream>
+
+namespace QtC {
+
+    /** Reference to characters owned by someone else (e.g. a reply
+        body). Only valid as long as the referenced buffer is. */
+    class StringRef {
+    public:
+        StringRef() : iData(nullptr), iSize(0) { }
+        StringRef(const char *aData, size_t aSize) : iData(aData), iSize(aSize) { }
+        StringRef(const std::string &aString) : iData(aString.data()), iSize(aString.size()) { }
+        StringRef(const char *aString) : iData(aString), iSize(strlen(aString)) { }
+
+        const char* data() const { return iData; }
+        size_t size() const { return iSize; }
+        bool empty() const { return iSize == 0; }
+
+        const char* begin() const { return iData; }
+        const char* end() const { return iData + iSize; }
+
+        std::string str() const { return std::string(iData, iSize); }
+
+        bool operator==(const StringRef &aOther) const {
+            return iSize == aOther.iSize && (iSize == 0 || memcmp(iData, aOther.iData, iSize) == 0);
+        }
+        bool operator!=(const StringRef &aOther) const { return !(*this == aOther); }
+
+        /** ASCII case-insensitive comparison, e.g. for HTTP header names. */
+        bool equalsIgnoreCase(const StringRef &aOther) const {
+            if (iSize != aOther.iSize)
+                return false;
+            for (size_t i = 0; i < iSize; ++i) {
+                unsigned char a = iData[i], b = aOther.iData[i];
+                if (a != b && ((a | 0x20) != (b | 0x20) || (unsigned char)((a | 0x20) - 'a') > 'z' - 'a'))
+                    return false;
+            }
+            return true;
+        }
+    private:
+        const char *iData;
+        size_t iSize;
+    };
+
+} /* namespace QtC */
+
+inline std::ostream& operator<<(std::ostream &aStream, const QtC::StringRef &aString) {
+    return aStream.write(aString.data(), aString.size());
+}
+
+#endif /* QTC_COMMON_STRINGREF_H */
@@ -6,8 +6,10 @@
 ** Author(s):  Jorma Tahtinen <Jorma.Tahtinen@digia.com>
 */
 
+#include <string.h>
+
+#include <algorithm>
 #include <vector>
-#include <sstream>
 
 #include "QtC/Common/URI.h"
 
@@ -15,6 +17,53 @@ using namespace std;
 
 namespace QtC {
 
+    /*
+    ** Percent-encoding tables
+    */
+    static const char gUnreserved[256] = {
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,
+        1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,
+        0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+        1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,1,
+        0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+        1,1,1,1,1,1,1,1,1,1,1,0,0,0,1,0
+        /* 0x80 .. 0xff: 0 */
+    };
+
+#define X 0x10
+    /* Value of a hex digit, X if the character is not one. */
+    static const unsigned char gHexValue[256] = {
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        0,1,2,3,4,5,6,7,8,9,X,X,X,X,X,X,
+        X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+        X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X
+    };
+#undef X
+
+    static const char gHexDigits[] = "0123456789ABCDEF";
+
+    /* Appends aData percent-encoded. */
+    static void appendEncoded(std::string &aResult, const char *aData, size_t aLength) {
+        size_t length = aResult.size();
+        
+        aResult.resize(length + 3*aLength);
+        aResult.resize(length + URI::encode(aData, aLength, &aResult[length]));
+    }
+
     /*
     ** UserIUnfo : username [ ":" password]
     */
@@ -79,15 +128,14 @@ namespace QtC {
     }
     
     std::string URI::UserInfo::toString() const {
-        std::ostringstream stream;
-        
-        stream << username();
+        std::string result(username());
         
         if (!password().empty()) {
-            stream << ":" << password();
+            result += ':';
+            result += password();
         }
         
-        return stream.str();
+        return result;
     }
 
 
@@ -171,19 +219,21 @@ namespace QtC {
     }
     
     std::string URI::Authority::toString() const {
-        std::ostringstream stream;
+        std::string result;
      
         if (!userInfo().empty()) {
-            stream << userInfo() << "@";
+            result += userInfo().toString();
+            result += '@';
         }
 
-        stream << hostname();
+        result += hostname();
         
         if (!port(false).empty()) {
-            stream << ":" << port(false);
+            result += ':';
+            result += port(false);
         }
         
-        return stream.str();
+        return result;
     }
 
     
@@ -245,16 +295,15 @@ namespace QtC {
     }
     
     std::string URI::Path::toString() const {
-        bool first=true;
-        std::ostringstream stream;
+        std::string result;
         std::vector<std::string>::const_iterator element;
         
         for(element=iPIMPL->elements.begin();element!=iPIMPL->elements.end();++element) {
-            if (first) first=false; else stream << "/";
-            stream << *element;
+            if (element!=iPIMPL->elements.begin()) result += '/';
+            result += *element;
         }
         
-        return stream.str();
+        return result;
     }
 
     /*
@@ -327,16 +376,17 @@ namespace QtC {
     }
     
     std::string URI::Query::toString() const {
-        bool first=true;
-        std::ostringstream stream;
+        std::string result;
         std::vector< std::pair<std::string,std::string> >::const_iterator i;
         
         for(i=iPIMPL->associations.begin();i!=iPIMPL->associations.end();++i) {
-            if (first) first=false; else stream << "&";
-            stream << encode((*i).first) << "=" << encode((*i).second);
+            if (i!=iPIMPL->associations.begin()) result += '&';
+            appendEncoded(result,(*i).first.data(),(*i).first.size());
+            result += '=';
+            appendEncoded(result,(*i).second.data(),(*i).second.size());
         }
         
-        return stream.str();
+        return result;
     }
 
     /*
@@ -387,17 +437,19 @@ namespace QtC {
         return iPIMPL->fragment;
     }
     std::string URI::FullPath::toString() const {
-        std::ostringstream stream;
+        std::string result;
         
         if (!path().empty()) {
-            stream << "/" << path();
+            result += '/';
+            result += path().toString();
         }
         
         if (!query().empty()) {
-            stream << "?" << query();
+            result += '?';
+            result += query().toString();
         }
         
-        return stream.str();
+        return result;
     }
     URIFullPathPrivate *URI::FullPath::pimpl() {
         return iPIMPL;
@@ -526,78 +578,85 @@ namespace QtC {
     }
 
     std::string URI::toString() const {
-        std::ostringstream stream;
+        std::string result;
         
         if (!scheme().empty()) {
-            stream << scheme() << "://";
+            result += scheme();
+            result += "://";
         }
         
-        stream << authority();
-
-        if (!path().empty()) {
-            stream << "/" << path();
-        }
-
-        if (!query().empty()) {
-            stream << "?" << query();
-        }
+        result += authority().toString();
+        result += fullpath().toString();
         
         if (!fragment().empty()) {
-            stream << "#" << fragment();
+            result += '#';
+            result += fragment();
         }
 
-        return stream.str();
+        return result;
     }
 
 
     std::string URI::encode(const std::string &aURLstring) {
-        char buf[4];
         std::string result;
-        std::string::const_iterator i;
-        
-        result.reserve(aURLstring.length());
-        
-        for(i=aURLstring.begin();i!=aURLstring.end();++i) {
-            switch(*i) {
-            case '0': case '1': case '2': case '3': case '4':
-            case '5': case '6': case '7': case '8': case '9':
-            case 'a': case 'b': case 'c': case 'd': case 'e':
-            case 'f': case 'g': case 'h': case 'i': case 'j':
-            case 'k': case 'l': case 'm': case 'n': case 'o':
-            case 'p': case 'q': case 'r': case 's': case 't':
-            case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
-            case 'A': case 'B': case 'C': case 'D': case 'E':
-            case 'F': case 'G': case 'H': case 'I': case 'J':
-            case 'K': case 'L': case 'M': case 'N': case 'O':
-            case 'P': case 'Q': case 'R': case 'S': case 'T':
-            case 'U': case 'V': case 'W': case 'X': case 'Y': case 'Z':
-            case '-': case '.': case '_': case '~':
-                result += *i;
-                break;
-            default:
-                snprintf(buf,4,"%%%02X",((unsigned int)(*i))&0xff);
-                result.append(buf,3);
-                break;
-            }
-        }
+        
+        appendEncoded(result,aURLstring.data(),aURLstring.size());
         return result;
     }
     std::string URI::decode(const std::string &aURLstring) {
-        std::string result;
+        std::string result(aURLstring.size(), 0);
         
-        std::string::const_iterator i;
+        result.resize(decode(aURLstring.data(),aURLstring.size(),&result[0]));
+        return result;
+    }
+
+    size_t URI::encode(const char *aData, size_t aLength, char *aOut) {
+        const unsigned char *p = (const unsigned char *)aData;
+        const unsigned char *end = p + aLength;
+        char *q = aOut;
         
-        for(i=aURLstring.begin();i!=aURLstring.end();++i) {
-            if (*i == '%' && isxdigit(*(i+1)) && isxdigit(*(i+2))) {
-                char *ptr,hexstr[3] = { *(i+1), *(i+2), 0 };
-                result += (char)(strtoul(hexstr,&ptr,16)&0xff);
-                i+=2;
+        for(;p!=end;++p) {
+            unsigned char c = *p;
+            if (gUnreserved[c]) {
+                *q++ = (char)c;
             } else {
-                result += *i;
+                q[0] = '%';
+                q[1] = gHexDigits[c >> 4];
+                q[2] = gHexDigits[c & 0xf];
+                q += 3;
             }
         }
+        return q - aOut;
+    }
+
+    size_t URI::decode(const char *aData, size_t aLength, char *aOut) {
+        const char *p = aData;
+        const char *end = aData + aLength;
+        char *q = aOut;
         
-        return result;
+        while (p != end) {
+            // Plain runs are copied as a block.
+            const char *escape = (const char *)memchr(p, '%', end - p);
+            if (escape == nullptr) escape = end;
+            memmove(q, p, escape - p);
+            q += escape - p;
+            p = escape;
+            if (p == end) break;
+            
+            unsigned char high = 0x10, low = 0x10;
+            if (end - p > 2) {
+                high = gHexValue[(unsigned char)p[1]];
+                low = gHexValue[(unsigned char)p[2]];
+            }
+            if ((high | low) & 0x10) {
+                // Not an escape, kept as is.
+                *q++ = *p++;
+            } else {
+                *q++ = (char)((high << 4) | low);
+                p += 3;
+            }
+        }
+        return q - aOut;
     }
 
     /*
@@ -634,6 +693,246 @@ namespace QtC {
         }
         
     }
+
+    /*
+    ** URIBuffer
+    */
+    URIBuffer::URIBuffer()
+        : iAuthority(0), iPath(0), iQuery(0), iFragment(0)
+    {
+    }
+
+    URIBuffer::URIBuffer(const std::string &aURI)
+        : iBuffer(aURI), iAuthority(0)
+    {
+        size_t r;
+        
+        r=aURI.find("://");
+        if (r != std::string::npos) {
+            iAuthority = r+3;
+        }
+        iPath = std::min(aURI.find_first_of("/?#",iAuthority), aURI.size());
+        iQuery = std::min(aURI.find_first_of("?#",iPath), aURI.size());
+        iFragment = std::min(aURI.find_first_of('#',iQuery), aURI.size());
+    }
+
+    void URIBuffer::clear() {
+        iBuffer.clear();
+        iAuthority = iPath = iQuery = iFragment = 0;
+    }
+
+    StringRef URIBuffer::range(size_t aBegin, size_t aEnd) const {
+        return StringRef(iBuffer.data()+aBegin, aEnd-aBegin);
+    }
+
+    /* Appends to the query section. */
+    void URIBuffer::insert(const char *aData, size_t aLength) {
+        iBuffer.insert(iFragment, aData, aLength);
+        grow(false, aLength);
+    }
+
+    /* Appends encoded to the end of the path or query section. */
+    void URIBuffer::insertEncoded(bool aPath, const char *aData, size_t aLength) {
+        size_t position = aPath ? iQuery : iFragment;
+        size_t end = iBuffer.size();
+        
+        // Encoded at the end, then rotated in place (no temporary).
+        appendEncoded(iBuffer, aData, aLength);
+        std::rotate(iBuffer.begin()+position, iBuffer.begin()+end, iBuffer.end());
+        grow(aPath, iBuffer.size()-end);
+    }
+
+    void URIBuffer::grow(bool aPath, size_t aLength) {
+        if (aPath) iQuery += aLength;
+        iFragment += aLength;
+    }
+
+    URIBuffer& URIBuffer::appendSegment(const char *aData, size_t aLength) {
+        if (iQuery-iPath != 1) {
+            // Not the root path "/" on its own.
+            iBuffer.insert(iQuery, 1, '/');
+            grow(true, 1);
+        }
+        insertEncoded(true, aData, aLength);
+        return *this;
+    }
+
+    URIBuffer& URIBuffer::appendPath(const URI::Path &aPath) {
+        for(size_t n=0;n<aPath.depth();++n) {
+            appendSegment(aPath[n]);
+        }
+        return *this;
+    }
+
+    URIBuffer& URIBuffer::appendEncodedPath(const char *aData, size_t aLength) {
+        iBuffer.insert(iQuery, aData, aLength);
+        grow(true, aLength);
+        return *this;
+    }
+
+    URIBuffer& URIBuffer::appendToSegment(const char *aData, size_t aLength) {
+        insertEncoded(true, aData, aLength);
+        return *this;
+    }
+
+    URIBuffer& URIBuffer::addParameter(const std::string &aName, const std::string &aValue) {
+        if (iQuery == iPath) {
+            // Request target needs a path.
+            iBuffer.insert(iQuery, 1, '/');
+            grow(true, 1);
+        }
+        insert((iFragment == iQuery) ? "?" : "&", 1);
+        insertEncoded(false, aName.data(), aName.size());
+        insert("=", 1);
+        insertEncoded(false, aValue.data(), aValue.size());
+        return *this;
+    }
+
+    void URIBuffer::setFragment(const std::string &aFragment) {
+        iBuffer.resize(iFragment);
+        if (!aFragment.empty()) {
+            iBuffer += '#';
+            iBuffer += aFragment;
+        }
+    }
+
+    StringRef URIBuffer::scheme() const {
+        return range(0, iAuthority ? iAuthority-3 : 0);
+    }
+    StringRef URIBuffer::authority() const {
+        return range(iAuthority, iPath);
+    }
+    StringRef URIBuffer::path() const {
+        return range(std::min(iPath+1, iQuery), iQuery);
+    }
+    StringRef URIBuffer::query() const {
+        return range(std::min(iQuery+1, iFragment), iFragment);
+    }
+    StringRef URIBuffer::fragment() const {
+        return range(std::min(iFragment+1, iBuffer.size()), iBuffer.size());
+    }
+
+    StringRef URIBuffer::target() const {
+        if (iFragment == iPath) {
+            return StringRef("/", 1);
+        }
+        return range(iPath, iFragment);
+    }
+
+    /*
+    ** URITemplate
+    */
+    URITemplate::URITemplate()
+        : iLength(0)
+    {
+    }
+
+    URITemplate::URITemplate(const std::string &aPattern)
+        : iLength(0)
+    {
+        size_t r,pos=0;
+        std::string literal;
+        
+        if (aPattern.empty() || aPattern[0] != '/') {
+            literal += '/';
+        }
+        while (pos < aPattern.size()) {
+            r=aPattern.find_first_of("/{",pos);
+            if (r == std::string::npos) r = aPattern.size();
+            appendEncoded(literal, aPattern.data()+pos, r-pos);
+            pos = r;
+            if (pos == aPattern.size()) break;
+            
+            if (aPattern[pos] == '/') {
+                literal += '/';
+                ++pos;
+                continue;
+            }
+            r=aPattern.find('}',pos);
+            if (r == std::string::npos) {
+                // Unterminated, taken literally.
+                appendEncoded(literal, aPattern.data()+pos, aPattern.size()-pos);
+                break;
+            }
+            if (!literal.empty()) {
+                Part part = { literal, false };
+                iParts.push_back(part);
+                iLength += literal.size();
+                literal.clear();
+            }
+            Part part = { aPattern.substr(pos+1,r-pos-1), true };
+            iParts.push_back(part);
+            pos = r+1;
+        }
+        if (!literal.empty()) {
+            Part part = { literal, false };
+            iParts.push_back(part);
+            iLength += literal.size();
+        }
+    }
+
+    URITemplate& URITemplate::bind(const std::string &aName, const std::string &aValue) {
+        std::vector<Part> parts;
+        
+        // Bound values join the surrounding literal text.
+        for(size_t n=0;n<iParts.size();++n) {
+            const Part &part = iParts[n];
+            if (part.variable && part.text != aName) {
+                parts.push_back(part);
+                continue;
+            }
+            if (parts.empty() || parts.back().variable) {
+                Part literal = { std::string(), false };
+                parts.push_back(literal);
+            }
+            if (part.variable) {
+                appendEncoded(parts.back().text, aValue.data(), aValue.size());
+            } else {
+                parts.back().text += part.text;
+            }
+        }
+        iLength = 0;
+        for(size_t n=0;n<parts.size();++n) {
+            if (!parts[n].variable) iLength += parts[n].text.size();
+        }
+        iParts.swap(parts);
+        return *this;
+    }
+
+    size_t URITemplate::variables() const {
+        size_t count = 0;
+        for(size_t n=0;n<iParts.size();++n) {
+            if (iParts[n].variable) ++count;
+        }
+        return count;
+    }
+
+    void URITemplate::expand(URIBuffer &aURI, std::initializer_list<StringRef> aValues) const {
+        std::initializer_list<StringRef>::const_iterator value = aValues.begin();
+        size_t length = iLength;
+        
+        for(;value!=aValues.end();++value) {
+            length += 3*value->size();
+        }
+        aURI.reserve(aURI.str().size() + length);
+        
+        value = aValues.begin();
+        for(size_t n=0;n<iParts.size();++n) {
+            const Part &part = iParts[n];
+            if (!part.variable) {
+                aURI.appendEncodedPath(part.text.data(), part.text.size());
+            } else if (value != aValues.end()) {
+                aURI.appendToSegment(value->data(), value->size());
+                ++value;
+            }
+        }
+    }
+
+    std::string URITemplate::toString(std::initializer_list<StringRef> aValues) const {
+        URIBuffer uri;
+        expand(uri, aValues);
+        return uri.str();
+    }
     
 } /* namespace QtC */
 
@@ -666,3 +965,13 @@ QtC::URI::Path& operator<<(QtC::URI::Path &aPath, const QtC::URI::Path &aOther)
     }
     return aPath;
 }
+
+QtC::URIBuffer& operator<<(QtC::URIBuffer &aURI, const std::string &aSegment) {
+    return aURI.appendSegment(aSegment);
+}
+QtC::URIBuffer& operator<<(QtC::URIBuffer &aURI, const QtC::URI::Path &aPath) {
+    return aURI.appendPath(aPath);
+}
+std::ostream& operator<<(std::ostream &os, const QtC::URIBuffer &aURI) {
+    return os << aURI.str();
+}
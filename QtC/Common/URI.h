@@ -13,6 +13,10 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <initializer_list>
+
+#include <QtC/Common/StringRef.h>
 
 namespace QtC {
 
@@ -169,10 +173,99 @@ namespace QtC {
     public:
         static std::string encode(const std::string &aURLstring);
         static std::string decode(const std::string &aURLstring);
+
+        /** Percent-encodes into aOut, which must have room for 3 * aLength
+            characters. Returns the number written. */
+        static size_t encode(const char *aData, size_t aLength, char *aOut);
+        /** Decodes into aOut (room for aLength, may be aData itself).
+            Returns the number written. */
+        static size_t decode(const char *aData, size_t aLength, char *aOut);
     private:
         struct URIPrivate *iPIMPL;
     };
 
+    /** URI stored in one contiguous buffer:
+        scheme "://" authority "/" path "?" query "#" fragment
+        Components are views into the buffer. Path segments and query
+        parameters are percent-encoded and appended in place, so with
+        reserve() building a request URI takes a single allocation.
+    */
+    class URIBuffer {
+    public:
+        URIBuffer();
+        explicit URIBuffer(const std::string &aURI);
+
+        void clear();
+        void reserve(size_t aCapacity) { iBuffer.reserve(aCapacity); }
+
+        /** Appends an encoded path segment. */
+        URIBuffer& appendSegment(const char *aData, size_t aLength);
+        URIBuffer& appendSegment(const std::string &aSegment) { return appendSegment(aSegment.data(), aSegment.size()); }
+        /** Appends the elements of aPath as segments. */
+        URIBuffer& appendPath(const URI::Path &aPath);
+        /** Appends already encoded path text, slashes included, as is. */
+        URIBuffer& appendEncodedPath(const char *aData, size_t aLength);
+        /** Encodes onto the end of the last path segment. */
+        URIBuffer& appendToSegment(const char *aData, size_t aLength);
+        /** Appends an encoded name=value query parameter. */
+        URIBuffer& addParameter(const std::string &aName, const std::string &aValue);
+        void setFragment(const std::string &aFragment);
+
+        StringRef scheme() const;
+        StringRef authority() const;
+        StringRef path() const;
+        StringRef query() const;
+        StringRef fragment() const;
+
+        /** Origin form request target, path and query ("/" if empty). */
+        StringRef target() const;
+
+        const std::string& str() const { return iBuffer; }
+    private:
+        StringRef range(size_t aBegin, size_t aEnd) const;
+        void insert(const char *aData, size_t aLength);
+        void insertEncoded(bool aPath, const char *aData, size_t aLength);
+        void grow(bool aPath, size_t aLength);
+    private:
+        std::string iBuffer;
+        /* Section offsets, a section starts with its delimiter ('/', '?', '#'). */
+        size_t iAuthority;
+        size_t iPath;
+        size_t iQuery;
+        size_t iFragment;
+    };
+
+    /** Route template such as "/v1/objects/{collection}/{id}". The
+        literal text is encoded once when the template is compiled, so
+        expanding it only encodes the variable values.
+    */
+    class URITemplate {
+    public:
+        URITemplate();
+        explicit URITemplate(const std::string &aPattern);
+
+        /** Substitutes a variable permanently, e.g. the collection name. */
+        URITemplate& bind(const std::string &aName, const std::string &aValue);
+
+        /** Number of variables not bound. */
+        size_t variables() const;
+        /** Length of the encoded literal text. */
+        size_t length() const { return iLength; }
+
+        /** Appends the path to aURI, aValues fill the unbound variables in order. */
+        void expand(URIBuffer &aURI, std::initializer_list<StringRef> aValues = {}) const;
+
+        /** Path for the values, as a string. */
+        std::string toString(std::initializer_list<StringRef> aValues = {}) const;
+    private:
+        struct Part {
+            std::string text;   // encoded literal or variable name
+            bool variable;
+        };
+        std::vector<Part> iParts;
+        size_t iLength;         // of the literal text
+    };
+
     class URL : public URI {
     public:
         URL();
@@ -197,4 +290,8 @@ std::ostream& operator<<(std::ostream &os, const QtC::URI &aURI);
 QtC::URI::Path& operator<<(QtC::URI::Path &aPath, const std::string &aElement);
 QtC::URI::Path& operator<<(QtC::URI::Path &aPath, const QtC::URI::Path &aOther);
 
+QtC::URIBuffer& operator<<(QtC::URIBuffer &aURI, const std::string &aSegment);
+QtC::URIBuffer& operator<<(QtC::URIBuffer &aURI, const QtC::URI::Path &aPath);
+std::ostream& operator<<(std::ostream &os, const QtC::URIBuffer &aURI);
+
 #endif /* QTC_COMMON_URI_H */
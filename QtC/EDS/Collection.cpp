@@ -61,36 +61,96 @@ namespace QtC {
         return iPIMPL->contentType;
     }
 
+    /*
+    ** JSONReplyConsumer : parses the reply body while it is received.
+    */
+    class JSONReplyConsumer : public HttpBodyConsumer {
+    public:
+        typedef std::shared_ptr<JSONReplyConsumer> var;
+    public:
+        JSONReplyConsumer(std::shared_ptr<JSON::KeyTable> aKeys)
+            : iKeys(aKeys), iBuilder(*aKeys), iLength(0)
+        {
+            iReader.reset();
+        }
+
+        virtual void consume(const char *aData, size_t aLength) {
+            iLength += aLength;
+            iReader.feed(aData, aLength, iBuilder);
+        }
+
+        /* Completes parsing, empty body gives null value. */
+        ErrorCode finish(JSON::Value &aValue) {
+            if (iLength == 0) {
+                return ErrorCode();
+            }
+            if (iReader.finish(iBuilder) != JSON::Reader::Complete) {
+                return boost::system::errc::make_error_code(boost::system::errc::bad_message);
+            }
+            aValue = std::move(iBuilder.value());
+            return ErrorCode();
+        }
+    private:
+        std::shared_ptr<JSON::KeyTable> iKeys;
+        JSON::Reader iReader;
+        JSON::ValueBuilder iBuilder;
+        size_t iLength;
+    };
+
     /*
     ** Collection
     */
     struct CollectionPrivate {
         CollectionPrivate()
             : eds(nullptr),
-              objectsPath("v1/objects"),
-              filesPath("v1/files")
+              filesRoute("/v1/files"),
+              fileRoute("/v1/files/{id}"),
+              fileDownloadRoute("/v1/files/{id}/download_url"),
+              keys(std::make_shared<JSON::KeyTable>())
         {}
 
+        void setCollectionName(const std::string &aCollectionName);
+        void findURI(URIBuffer &aURI, const JSON::Object &aQuery);
         
         HttpRequest::var prepareRequest(HttpRequest::var request);
         void restRequest(HttpRequest::var aRequest, Collection::Callback aCallback);
+        void documentRequest(HttpRequest::var aRequest, Collection::DocumentCallback aCallback);
 
         struct EDSPrivate *eds;
         std::string collectionName;
 
-        URI::Path objectsPath;
-        URI::Path filesPath;
+        /* REST routes, encoded once with the collection name bound. */
+        URITemplate objectsRoute;
+        URITemplate objectRoute;
+        URITemplate filesRoute;
+        URITemplate fileRoute;
+        URITemplate fileDownloadRoute;
+
+        /* Object keys shared by all replies of this collection (worker thread only). */
+        std::shared_ptr<JSON::KeyTable> keys;
     };
 
+    void CollectionPrivate::setCollectionName(const std::string &aCollectionName) {
+        collectionName = aCollectionName;
+        objectsRoute = URITemplate("/v1/objects/{collection}").bind("collection", aCollectionName);
+        objectRoute = URITemplate("/v1/objects/{collection}/{id}").bind("collection", aCollectionName);
+    }
+
+    void CollectionPrivate::findURI(URIBuffer &aURI, const JSON::Object &aQuery) {
+        if (aQuery.size()>0) {
+            std::string query = aQuery.toString();
+            // Room for the worst case encoding, a single allocation.
+            aURI.reserve(objectsRoute.length() + 3 + 3*query.size());
+            objectsRoute.expand(aURI);
+            aURI.addParameter("q",query);
+        } else {
+            objectsRoute.expand(aURI);
+        }
+    }
+
     HttpRequest::var CollectionPrivate::prepareRequest(HttpRequest::var request) {
         if (eds) {
-            const URL &url = eds->connectionPool->url();
-            const URL::Authority &authority = url.authority();
-            
-            request->addHeader("Host",               authority.hostname());
-            request->addHeader("Accept-Encoding",    "*"                 );
-            request->addHeader("User-Agent",         "qtc-sdk-cpp/1.0"   );
-            request->addHeader("Enginio-Backend-Id", eds->backendId      );
+            request->setCommonHeaders(eds->headers);
         }
         return request;
     }
@@ -116,8 +176,11 @@ namespace QtC {
             return;
         }
         
-        connection->query(aRequest, [pool,connection,aCallback](const boost::system::error_code& aError,
-                                                                HttpReply::var aReply)
+        JSONReplyConsumer::var consumer = std::make_shared<JSONReplyConsumer>(keys);
+        aRequest->setBodyConsumer(consumer);
+
+        connection->query(aRequest, [pool,connection,consumer,aCallback](const boost::system::error_code& aError,
+                                                                         HttpReply::var /*aReply*/)
                           {
                               if (aError) {
                                   if (aCallback) {
@@ -125,13 +188,51 @@ namespace QtC {
                                   }
                               } else {
                                   if (aCallback) {
-                                      aCallback(aError,JSON::parseString(aReply->body()));
+                                      JSON::Value value;
+                                      ErrorCode error = consumer->finish(value);
+                                      aCallback(error,std::move(value));
                                   }
                                   pool->releaseConnection(connection);
                               }
                           });
     }
     
+    void CollectionPrivate::documentRequest(HttpRequest::var aRequest, Collection::DocumentCallback aCallback) {
+        HttpConnectionPool::var pool;
+        HttpConnection::var connection;
+
+        if (eds) {
+            pool = eds->connectionPool;
+        }
+        if (pool) {
+            connection = pool->getConnection();
+        }
+
+        if (!connection) {
+            // TODO Improve error code
+            aCallback(boost::system::error_code(),JSON::Document());
+            return;
+        }
+
+        connection->query(aRequest, [pool,connection,aCallback](const boost::system::error_code& aError,
+                                                                HttpReply::var aReply)
+                          {
+                              JSON::Document document;
+                              if (aError) {
+                                  aCallback(aError,document);
+                              } else {
+                                  // Index the body in place, the reply keeps it alive.
+                                  const std::string &body = aReply->body();
+                                  ErrorCode error;
+                                  if (!body.empty() && !document.parse(body.data(), body.size(), aReply)) {
+                                      error = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                                  }
+                                  aCallback(error,document);
+                                  pool->releaseConnection(connection);
+                              }
+                          });
+    }
+
     Collection::Collection() 
         : iPIMPL(new CollectionPrivate)
     {
@@ -141,13 +242,15 @@ namespace QtC {
         : iPIMPL(new CollectionPrivate)
     {
         iPIMPL->eds=aOther.iPIMPL->eds;
+        iPIMPL->setCollectionName(aOther.iPIMPL->collectionName);
+        iPIMPL->keys=aOther.iPIMPL->keys;
     }
     
     Collection::Collection(EDS &aEDS,const std::string &aCollectionName) 
         : iPIMPL(new CollectionPrivate)
     {
         iPIMPL->eds = aEDS.pimpl();
-        iPIMPL->collectionName = aCollectionName;
+        iPIMPL->setCollectionName(aCollectionName);
     }
 
     Collection::~Collection() {
@@ -156,6 +259,8 @@ namespace QtC {
     
     Collection& Collection::operator=(const Collection &aOther) {
         iPIMPL->eds=aOther.iPIMPL->eds;
+        iPIMPL->setCollectionName(aOther.iPIMPL->collectionName);
+        iPIMPL->keys=aOther.iPIMPL->keys;
         return *this;
     }
 
@@ -182,16 +287,13 @@ namespace QtC {
         pool = iPIMPL->eds->connectionPool;
         connection = pool->getConnection();
         
-        URI uri;
-        uri.path() << iPIMPL->objectsPath << iPIMPL->collectionName;
-        if (aQuery.size()>0) {
-            uri.query().addAssociation("q",aQuery.toString());
-        }
+        URIBuffer uri;
+        iPIMPL->findURI(uri, aQuery);
         
         HttpRequest::var request;
         request=iPIMPL->prepareRequest(HttpRequest::getGet(uri));
         
-        std::cout << "URI = " << uri.fullpath() << "\n";
+        std::cout << "URI = " << uri.target() << "\n";
 
         /*
         // create query string
@@ -204,15 +306,18 @@ namespace QtC {
         if(options.include) qsObj.include = JSON.stringify(options.include);
         */
 
-        connection->query(request, [pool,connection,aCallback](const boost::system::error_code& aError,
-                                                               HttpReply::var aReply)
+        JSONReplyConsumer::var consumer = std::make_shared<JSONReplyConsumer>(iPIMPL->keys);
+        request->setBodyConsumer(consumer);
+
+        connection->query(request, [pool,connection,consumer,aCallback](const boost::system::error_code& aError,
+                                                                        HttpReply::var /*aReply*/)
                           {
                               if (aError) {
                                   aCallback(aError,JSON::Value());
                               } else {
-                                  //std::cout << "Got reply" << std::endl;
-                                  //std::cout << aReply->body() << std::endl;
-                                  aCallback(aError,JSON::parseString(aReply->body()));
+                                  JSON::Value value;
+                                  ErrorCode error = consumer->finish(value);
+                                  aCallback(error,std::move(value));
                               }
                               
                               pool->releaseConnection(connection);
@@ -220,17 +325,33 @@ namespace QtC {
         
     }
 
+    void Collection::findDocument(const JSON::Object &aQuery, DocumentCallback aCallback) {
+        URIBuffer uri;
+        iPIMPL->findURI(uri, aQuery);
+
+        iPIMPL->documentRequest(iPIMPL->prepareRequest(HttpRequest::getGet(uri)),
+                                aCallback);
+    }
+
+    void Collection::findOneDocument(const std::string &aObjectId, DocumentCallback aCallback) {
+        URIBuffer uri;
+        iPIMPL->objectRoute.expand(uri, { aObjectId });
+
+        iPIMPL->documentRequest(iPIMPL->prepareRequest(HttpRequest::getGet(uri)),
+                                aCallback);
+    }
+
     void Collection::findOne(const std::string &aObjectId, Callback aCallback) {
-        URI uri;
-        uri.path() << iPIMPL->objectsPath << iPIMPL->collectionName << aObjectId;
+        URIBuffer uri;
+        iPIMPL->objectRoute.expand(uri, { aObjectId });
         
         iPIMPL->restRequest(iPIMPL->prepareRequest(HttpRequest::getGet(uri)), 
                             aCallback);
     }
     
     void Collection::insert(const JSON::Object &aValue, Callback aCallback) {
-        URI uri;
-        uri.path() << iPIMPL->objectsPath << iPIMPL->collectionName;
+        URIBuffer uri;
+        iPIMPL->objectsRoute.expand(uri);
 
         HttpRequest::var request;
         request=iPIMPL->prepareRequest(HttpRequest::getPost(uri));
@@ -240,8 +361,8 @@ namespace QtC {
     }
 
     void Collection::update(const std::string &aObjectId, const JSON::Object &aValue, Callback aCallback) {
-        URI uri;
-        uri.path() << iPIMPL->objectsPath << iPIMPL->collectionName << aObjectId;
+        URIBuffer uri;
+        iPIMPL->objectRoute.expand(uri, { aObjectId });
         
         HttpRequest::var request;
         request=iPIMPL->prepareRequest(HttpRequest::getPut(uri));        
@@ -250,11 +371,46 @@ namespace QtC {
         iPIMPL->restRequest(request, aCallback);
     }
 
+    void Collection::update(const std::string &aObjectId, const JSON::Object &aBaseline,
+                            const JSON::Object &aValue, Callback aCallback)
+    {
+        JSON::Object patch = JSON::diff(aBaseline, aValue);
+        if (patch.size() == 0) {
+            // Nothing changed, no round trip.
+            if (aCallback)
+                aCallback(boost::system::error_code(), JSON::Value(aBaseline));
+            return;
+        }
+        updateBody(aObjectId, patch.toString(), aCallback);
+    }
+
+    void Collection::insertBody(std::string aBody, Callback aCallback) {
+        URIBuffer uri;
+        iPIMPL->objectsRoute.expand(uri);
+
+        HttpRequest::var request;
+        request=iPIMPL->prepareRequest(HttpRequest::getPost(uri));
+        request->setBody(std::move(aBody));
+
+        iPIMPL->restRequest(request, aCallback);
+    }
+
+    void Collection::updateBody(const std::string &aObjectId, std::string aBody, Callback aCallback) {
+        URIBuffer uri;
+        iPIMPL->objectRoute.expand(uri, { aObjectId });
+
+        HttpRequest::var request;
+        request=iPIMPL->prepareRequest(HttpRequest::getPut(uri));
+        request->setBody(std::move(aBody));
+
+        iPIMPL->restRequest(request, aCallback);
+    }
+
     void Collection::remove(const std::string &aObjectId,
                             Callback aCallback)
     {
-        URI uri;
-        uri.path() << iPIMPL->objectsPath << iPIMPL->collectionName << aObjectId;
+        URIBuffer uri;
+        iPIMPL->objectRoute.expand(uri, { aObjectId });
         
         HttpRequest::var request;
         request=iPIMPL->prepareRequest(HttpRequest::getDelete(uri));
@@ -267,8 +423,8 @@ namespace QtC {
                                 FileUploadStream aFileReader,
                                 Callback aCallback)
     {
-        URI uri;
-        uri.path() << iPIMPL->filesPath;
+        URIBuffer uri;
+        iPIMPL->filesRoute.expand(uri);
         
         HttpRequest::var request;
         request=iPIMPL->prepareRequest(HttpRequest::getPost(uri));
@@ -324,8 +480,8 @@ namespace QtC {
     void Collection::getFileInfo(const std::string &aFileId, 
                                  Callback aCallback)
     {
-        URI uri;
-        uri.path() << iPIMPL->filesPath << aFileId;
+        URIBuffer uri;
+        iPIMPL->fileRoute.expand(uri, { aFileId });
         
         iPIMPL->restRequest(iPIMPL->prepareRequest(HttpRequest::getGet(uri)), aCallback);
     }
@@ -334,10 +490,10 @@ namespace QtC {
                                         Callback aCallback,
                                         const std::string &aVariant)
     {
-        URI uri;
-        uri.path() << iPIMPL->filesPath << aFileId << "download_url";
+        URIBuffer uri;
+        iPIMPL->fileDownloadRoute.expand(uri, { aFileId });
         if (!aVariant.empty()) {
-            uri.query().addAssociation("variant",aVariant);
+            uri.addParameter("variant",aVariant);
         }
         
         iPIMPL->restRequest(iPIMPL->prepareRequest(HttpRequest::getGet(uri)), aCallback);
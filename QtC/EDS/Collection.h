@@ -18,6 +18,7 @@
 #include <boost/system/error_code.hpp>
 
 #include <QtC/Common/JSON.h>
+#include <QtC/Common/JSONBinding.h>
 
 namespace QtC {
 
@@ -51,6 +52,8 @@ namespace QtC {
                                     JSON::Value aValue)> Callback;
         typedef std::function<void (const boost::system::error_code& aError, 
                                     JSON::Value aValue)> FileDownloadCallback;
+        typedef std::function<void (const boost::system::error_code& aError,
+                                    JSON::Document aDocument)> DocumentCallback;
     public:
         Collection();
         Collection(const Collection &aOther);
@@ -66,9 +69,35 @@ namespace QtC {
         
         /* Asynchronous API's */
         void find(const JSON::Object &aQuery, Callback aCallback);
+        /* Lazy variants of find/findOne, the document references the reply body. */
+        void findDocument(const JSON::Object &aQuery, DocumentCallback aCallback);
+        void findOneDocument(const std::string &aObjectId, DocumentCallback aCallback);
+
+        /* Typed API's for structs bound with QTC_JSON_BINDING */
+        template <class T>
+        void findAs(const JSON::Object &aQuery,
+                    std::function<void (const ErrorCode &aError, std::vector<T> aResults)> aCallback);
+        template <class T>
+        void findOneAs(const std::string &aObjectId,
+                       std::function<void (const ErrorCode &aError, T aValue)> aCallback);
+        template <class T>
+        typename std::enable_if<JSON::Binding<T>::bound>::type
+        insert(const T &aValue, Callback aCallback) {
+            insertBody(JSON::toString(aValue), aCallback);
+        }
+        template <class T>
+        typename std::enable_if<JSON::Binding<T>::bound>::type
+        update(const std::string &aObjectId, const T &aValue, Callback aCallback) {
+            updateBody(aObjectId, JSON::toString(aValue), aCallback);
+        }
         void findOne(const std::string &aObjectId, Callback aCallback);
         void insert(const JSON::Object &aValue, Callback aCallback);
         void update(const std::string &aObjectId, const JSON::Object &aValue, Callback aCallback);
+        /* Sends only the members changed since aBaseline, as a merge patch.
+           When nothing changed no request is made, aCallback is called
+           right away with aBaseline. */
+        void update(const std::string &aObjectId, const JSON::Object &aBaseline,
+                    const JSON::Object &aValue, Callback aCallback);
         void remove(const std::string &aObjectId, Callback aCallback);
 
         void attachFile(const std::string &aObjectId, 
@@ -157,9 +186,40 @@ Collection.prototype.downloadFile = function(fileId, filePath, variant, cb){
           edsFileDownloadRequest: edsFileDownloadRequest
           }
         */
+    private:
+        void insertBody(std::string aBody, Callback aCallback);
+        void updateBody(const std::string &aObjectId, std::string aBody, Callback aCallback);
     private:
         struct CollectionPrivate *iPIMPL;
     };
+
+    template <class T>
+    void Collection::findAs(const JSON::Object &aQuery,
+                            std::function<void (const ErrorCode &aError, std::vector<T> aResults)> aCallback)
+    {
+        findDocument(aQuery, [aCallback](const ErrorCode &aError, JSON::Document aDocument) {
+                std::vector<T> results;
+                ErrorCode error = aError;
+                if (!error && aDocument.isValid() && !JSON::decode(aDocument["results"], results)) {
+                    error = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                }
+                aCallback(error, std::move(results));
+            });
+    }
+
+    template <class T>
+    void Collection::findOneAs(const std::string &aObjectId,
+                               std::function<void (const ErrorCode &aError, T aValue)> aCallback)
+    {
+        findOneDocument(aObjectId, [aCallback](const ErrorCode &aError, JSON::Document aDocument) {
+                T value;
+                ErrorCode error = aError;
+                if (!error && aDocument.isValid() && !JSON::decode(aDocument, value)) {
+                    error = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                }
+                aCallback(error, std::move(value));
+            });
+    }
     
 } /* namespace QtC */
 
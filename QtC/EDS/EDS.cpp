@@ -21,6 +21,13 @@ namespace QtC {
     {
         iPIMPL->backendId      = aBackendId;
         iPIMPL->connectionPool = HttpConnectionPool::get(aURL);
+
+        std::shared_ptr<HttpHeaderBlock> headers = std::make_shared<HttpHeaderBlock>();
+        headers->add("Host",               aURL.authority().hostname())
+                .add("Accept-Encoding",    "*"                         )
+                .add("User-Agent",         "qtc-sdk-cpp/1.0"           )
+                .add("Enginio-Backend-Id", aBackendId                  );
+        iPIMPL->headers = headers;
     }
     
     EDS::~EDS() {
@@ -18,6 +18,8 @@ namespace QtC {
     struct EDSPrivate {
         std::string backendId;
         HttpConnectionPool::var connectionPool;
+        /* Host, Accept-Encoding, User-Agent and Enginio-Backend-Id. */
+        HttpHeaderBlock::var headers;
     };
     
 } /* namespace QtC */
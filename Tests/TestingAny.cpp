@@ -0,0 +1,80 @@
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <typeinfo>
+
+#include <QtC/Common/Any.h>
+
+using namespace std;
+using namespace QtC;
+
+static int failures = 0;
+
+static void check(bool aCondition, const char *aWhat) {
+  if (!aCondition) {
+    cerr << "FAILED: " << aWhat << endl;
+    failures++;
+  }
+}
+
+void test_values() {
+  Any none;
+  check(none.is_null() && !none.is<int>(), "empty");
+
+  Any number(42);
+  check(number.not_null() && number.is<int>() && !number.is<long>() && number.as<int>() == 42, "inline value");
+  int value = number;
+  check(value == 42, "conversion");
+
+  Any text(string("hello"));
+  check(text.is<string>() && text.as<const string&>() == "hello", "string value");
+
+  bool thrown = false;
+  try {
+    text.as<int>();
+  } catch (const bad_cast&) {
+    thrown = true;
+  }
+  check(thrown, "bad cast");
+
+  vector<int> big(100, 7);
+  Any large(big);
+  check(large.is<vector<int> >() && large.as<vector<int> >().size() == 100, "heap value");
+}
+
+void test_copies() {
+  Any a(string(64, 'x'));
+  Any b(a);
+  b.as<string>()[0] = 'y';
+  check(a.as<string>()[0] == 'x' && b.as<string>()[0] == 'y', "copy is deep");
+
+  Any c(std::move(b));
+  check(b.is_null() && c.as<string>()[0] == 'y', "move");
+
+  a = c;
+  check(a.as<string>()[0] == 'y', "copy assign");
+  a = 3.5;
+  check(a.is<double>() && a.as<double>() == 3.5, "assign other type");
+
+  shared_ptr<int> shared = make_shared<int>(1);
+  {
+    Any owner(shared);
+    Any moved(std::move(owner));
+    check(shared.use_count() == 2, "inline move keeps one owner");
+  }
+  check(shared.use_count() == 1, "destroyed");
+
+  static_assert(is_nothrow_move_constructible<Any>::value, "noexcept move");
+}
+
+int main() {
+  cout << "Testing.." << endl;
+
+  test_values();
+  test_copies();
+
+  cout << (failures ? "FAILED" : "OK") << endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <vector>
+
+#include <QtC/Common/Base64.h>
+
+using namespace std;
+using namespace QtC;
+
+static int failures = 0;
+
+static void check(bool aCondition, const char *aWhat) {
+  if (!aCondition) {
+    cerr << "FAILED: " << aWhat << endl;
+    failures++;
+  }
+}
+
+static string random(size_t aLength) {
+  string result(aLength, '\0');
+  for (size_t i = 0; i < aLength; i++)
+    result[i] = (char)(rand() & 0xff);
+  return result;
+}
+
+static string spanEncode(const string &aInput) {
+  string result(Base64::encodedLength(aInput.size()), '\0');
+  result.resize(Base64::encode(aInput.data(), aInput.size(), &result[0]));
+  return result;
+}
+
+static string streamEncode(const string &aInput) {
+  istringstream input(aInput);
+  ostringstream output;
+  Base64::encode(input, output);
+  return output.str();
+}
+
+static string streamDecode(const string &aInput) {
+  istringstream input(aInput);
+  ostringstream output;
+  Base64::decode(input, output);
+  return output.str();
+}
+
+void test_vectors() {
+  // RFC 4648, section 10
+  const char *vectors[][2] = {
+    { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+    { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" }
+  };
+  for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+    check(spanEncode(vectors[i][0]) == vectors[i][1], "encode vector");
+    check(Base64::decode(string(vectors[i][1])) == vectors[i][0], "decode vector");
+  }
+  check(Base64::decode(string("Zm9v\r\nYmFy")) == "foobar", "decode skips line breaks");
+  check(Base64::decode(string("Zg")) == "f" && Base64::decode(string("Zm9")) == "fo", "decode unpadded");
+}
+
+void test_lengths() {
+  for (size_t length = 0; length < 300; length++) {
+    string data = random(length);
+    string code = spanEncode(data);
+    string lines = Base64::encode(data);
+
+    check(code.size() == Base64::encodedLength(length), "encoded length");
+    check(lines == streamEncode(data), "encode matches the Encoder");
+    check(Base64::decode(code) == data && Base64::decode(lines) == data, "round trip");
+    check(Base64::decode(code).size() <= Base64::decodedLength(code.size()), "decoded length");
+  }
+}
+
+void test_invalid() {
+  // Characters outside of the alphabet in the middle of vector blocks.
+  for (int round = 0; round < 200; round++) {
+    string code = spanEncode(random(rand() % 200));
+    string noisy = code;
+    for (int i = rand() % 4; i > 0; i--)
+      noisy.insert(rand() % (noisy.size() + 1), 1, "\n =*\x80\xff-_"[rand() % 8]);
+    check(Base64::decode(noisy) == streamDecode(noisy), "decode matches the Decoder");
+  }
+
+  string data = random(100);
+  string code = spanEncode(data);
+  code.insert(40, "\n");
+  check(Base64::decode(code) == data, "line break inside a block");
+}
+
+void test_incremental() {
+  string data = random(1000);
+  string code = spanEncode(data);
+
+  // Any split of the input gives the same output.
+  for (int round = 0; round < 50; round++) {
+    Base64::Encoder encoder = Base64::Encoder(Base64::Options());
+    Base64::Decoder decoder;
+    string encoded(encoder.maxLength(data.size()), '\0');
+    string decoded(decoder.maxLength(code.size()), '\0');
+    size_t split = rand() % data.size();
+    size_t length = encoder.encodeBlock(data.data(), split, &encoded[0]);
+    length += encoder.encodeBlock(data.data() + split, data.size() - split, &encoded[length]);
+    length += encoder.encodeBlockEnd(&encoded[length]);
+    check(encoded.substr(0, length) == code, "encode in two blocks");
+
+    split = rand() % code.size();
+    length = decoder.decodeBlock(code.data(), split, &decoded[0]);
+    length += decoder.decodeBlock(code.data() + split, code.size() - split, &decoded[length]);
+    check(decoded.substr(0, length) == data, "decode in two blocks");
+  }
+
+  string big = random(20000);
+  check(streamEncode(big) == Base64::encode(big) && streamDecode(Base64::encode(big)) == big,
+        "streams across buffer boundaries");
+
+  vector<boost::asio::const_buffer> buffers;
+  buffers.push_back(boost::asio::buffer(data.data(), 10));
+  buffers.push_back(boost::asio::buffer(data.data() + 10, 1));
+  buffers.push_back(boost::asio::buffer(data.data() + 11, data.size() - 11));
+  Base64::Encoder encoder = Base64::Encoder(Base64::Options());
+  string encoded(encoder.maxLength(boost::asio::buffer_size(buffers)), '\0');
+  size_t length = encoder.encodeBlock(buffers, &encoded[0]);
+  length += encoder.encodeBlockEnd(&encoded[length]);
+  check(encoded.substr(0, length) == code, "encode buffer sequence");
+}
+
+void test_options() {
+  string data = random(200);
+  Base64::Encoder mime(Base64::Options(Base64::Standard, 76));
+  string code(mime.maxLength(data.size()), '\0');
+  size_t length = mime.encodeBlock(data.data(), data.size(), &code[0]);
+  code.resize(length + mime.encodeBlockEnd(&code[length]));
+  check(code.find("\r\n") == 76 && code.find("\r\n", 78) == 154, "line length");
+  check(Base64::decode(code) == data, "decode wrapped lines");
+
+  const char bytes[] = { (char)0xfb, (char)0xff, (char)0xbf, 'a' };
+  Base64::Encoder url(Base64::Options(Base64::URLSafe, 0, "", false));
+  char output[16];
+  length = url.encodeBlock(bytes, sizeof(bytes), output);
+  length += url.encodeBlockEnd(output + length);
+  check(string(output, length) == "-_-_YQ", "url-safe alphabet without padding");
+
+  Base64::Decoder decoder(Base64::URLSafe);
+  length = decoder.decodeBlock("-_-_YQ", 6, output);
+  check(string(output, length) == string(bytes, sizeof(bytes)), "url-safe decode");
+}
+
+int main() {
+  cout << "Testing.." << endl;
+
+  test_vectors();
+  test_lengths();
+  test_invalid();
+  test_incremental();
+  test_options();
+
+  cout << (failures ? "FAILED" : "OK") << endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,632 @@
+
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <QtC/Common/JSON.h>
+#include <QtC/Common/JSONBinding.h>
+
+using namespace std;
+using namespace QtC;
+
+static int failures = 0;
+
+static void check(bool aCondition, const char *aWhat) {
+  if (!aCondition) {
+    cerr << "FAILED: " << aWhat << endl;
+    failures++;
+  }
+}
+
+void test_writer() {
+  JSON::Writer writer;
+
+  writer.write(JSON::Object({ JSON::String("name")  | "Doe",
+	                      JSON::String("age")   | 32,
+	                      JSON::String("ratio") | 0.1,
+	                      JSON::String("likes") | JSON::Array({"chili", true, JSON::Value()}) }));
+  check(writer.str() == "{\"age\":32,\"likes\":[\"chili\",true,null],\"name\":\"Doe\",\"ratio\":0.1}",
+	"compact object");
+
+  writer.clear();
+  writer.write(JSON::Value(std::string("a\"b\\c\n\x01/")));
+  check(writer.str() == "\"a\\\"b\\\\c\\n\\u0001/\"", "string escaping");
+
+  writer.clear();
+  writer.beginArray().integer(-9223372036854775807LL - 1).number(1e300).number(3.0).number(1.0/3).endArray();
+  check(writer.str() == "[-9223372036854775808,1e+300,3.0,0.3333333333333333]", "numbers");
+}
+
+/* Collects the titles of a find result without building a tree. */
+class TitleCollector : public JSON::Handler {
+public:
+  TitleCollector() : iDepth(0), iTitle(false) {}
+
+  virtual bool beginObject() { iDepth++; return true; }
+  virtual bool endObject() { iDepth--; return true; }
+  virtual bool key(const char *aData, size_t aLength) {
+    iTitle = (iDepth == 2 && std::string(aData, aLength) == "title");
+    return true;
+  }
+  virtual bool string(const char *aData, size_t aLength) {
+    if (iTitle)
+      iTitles.push_back(std::string(aData, aLength));
+    iTitle = false;
+    return true;
+  }
+
+  std::vector<std::string> iTitles;
+private:
+  int iDepth;
+  bool iTitle;
+};
+
+void test_reader() {
+  JSON::Reader reader;
+  TitleCollector titles;
+  
+  check(reader.parse("{ \"results\": [ { \"title\": \"a\\\"b\", \"n\": [1, -2.5e3, true, null] },\n"
+		     "                 { \"title\": \"\\u00e4\", \"o\": {} } ] }", titles) == JSON::Reader::Complete,
+	"reader complete");
+  check(titles.iTitles.size() == 2 && titles.iTitles[0] == "a\"b" && titles.iTitles[1] == "\xc3\xa4",
+	"reader strings");
+
+  JSON::Handler ignore;
+  check(reader.parse("[1,]", ignore) == JSON::Reader::SyntaxError && reader.errorOffset() == 3,
+	"reader syntax error");
+  check(reader.parse("{\"a\":1} x", ignore) == JSON::Reader::SyntaxError, "reader trailing data");
+}
+
+void test_keys() {
+  JSON::KeyTable keys;
+  JSON::Value first = JSON::parseString("{\"a_rather_long_field_name\":1}", keys);
+  JSON::Value second = JSON::parseString("{\"a_rather_long_field_name\":2}", keys);
+  const JSON::Object &firstObject = first.object_ref();
+  const JSON::Object &secondObject = second.object_ref();
+  check(keys.size() == 1 && &firstObject.begin()->first.str() == &secondObject.begin()->first.str(),
+        "records share interned keys");
+
+  JSON::KeyTable small(1);
+  JSON::Key a = small.intern("a", 1);
+  JSON::Key b1 = small.intern("b", 1);
+  JSON::Key b2 = small.intern("b", 1);
+  check(small.size() == 1 && &small.intern("a", 1).str() == &a.str() &&
+        b1 == b2 && &b1.str() != &b2.str(), "keys past the capacity are not interned");
+}
+
+void test_incremental() {
+  const std::string text = "{\"results\":[{\"id\":\"532c49d0\",\"age\":-32,\"f\":1.5e-3,"
+                           "\"s\":\"x\\u00e4\\\"y\",\"ok\":false,\"n\":null},[],{}],\"count\":12345}";
+  JSON::Reader reader;
+  JSON::ValueBuilder whole;
+  check(reader.parse(text, whole) == JSON::Reader::Complete, "builder complete");
+
+  JSON::Writer expected;
+  expected.write(whole.value());
+
+  // Every split position, and byte by byte.
+  for (size_t chunk = 1; chunk <= text.size(); ++chunk) {
+    JSON::ValueBuilder builder;
+    reader.reset();
+    for (size_t pos = 0; pos < text.size(); pos += chunk) {
+      reader.feed(text.data() + pos, std::min(chunk, text.size() - pos), builder);
+    }
+    JSON::Writer writer;
+    check(reader.finish(builder) == JSON::Reader::Complete, "incremental complete");
+    writer.write(builder.value());
+    check(writer.str() == expected.str(), "incremental result");
+  }
+
+  // A long string cut many times, with escapes and UTF-8 on the cuts.
+  const std::string longText = "{\"" + std::string(20000, 'k') + "\":[\"" + std::string(50000, 'a') +
+                               "\\\\\\\"\xc3\xa4\\u00e4" + std::string(5000, 'b') + "\",\"\\\\\"]}";
+  JSON::ValueBuilder longWhole;
+  check(reader.parse(longText, longWhole) == JSON::Reader::Complete, "long string complete");
+  const size_t chunks[] = { 1, 2, 3, 7, 4096 };
+  for (size_t n = 0; n < sizeof(chunks) / sizeof(chunks[0]); ++n) {
+    JSON::ValueBuilder builder;
+    reader.reset();
+    for (size_t pos = 0; pos < longText.size(); pos += chunks[n])
+      reader.feed(longText.data() + pos, std::min(chunks[n], longText.size() - pos), builder);
+    check(reader.finish(builder) == JSON::Reader::Complete && builder.value() == longWhole.value(),
+          "long string in chunks");
+  }
+
+  const std::string badText = "[\"" + std::string(100, 'a') + "\xc3x\"]";
+  for (size_t chunk = 1; chunk < 8; ++chunk) {
+    JSON::ValueBuilder builder;
+    reader.reset();
+    for (size_t pos = 0; pos < badText.size(); pos += chunk)
+      reader.feed(badText.data() + pos, std::min(chunk, badText.size() - pos), builder);
+    check(reader.finish(builder) == JSON::Reader::SyntaxError && reader.errorOffset() == 102,
+          "invalid UTF-8 across chunks");
+  }
+
+  JSON::ValueBuilder reused;
+  check(reader.parse("{\"a\":[1,2", reused) == JSON::Reader::SyntaxError, "builder failed parse");
+  reused.reset();
+  check(reader.parse("{\"x\":[4]}", reused) == JSON::Reader::Complete &&
+        JSON::toString(reused.value()) == "{\"x\":[4]}", "builder reset after failure");
+
+  JSON::ValueBuilder builder;
+  reader.reset();
+  reader.feed("[1, 2", 5, builder);
+  check(reader.finish(builder) == JSON::Reader::SyntaxError && reader.errorOffset() == 5,
+	"incremental truncated");
+}
+
+void test_document() {
+  const std::string text =
+    "{ \"results\": [ { \"id\": \"a1\", \"title\": \"First\", \"count\": 3 },\n"
+    "                { \"id\": \"a2\", \"title\": \"Sec\\\"ond\", \"count\": 2.5,\n"
+    "                  \"tags\": [true, null, 12345678901234567890] } ] }";
+  JSON::Document document;
+
+  check(document.parse(text), "document parse");
+  JSON::Document::Node results = document["results"];
+  check(results.type() == JSON::ARRAY && results.size() == 2, "document array");
+  check(results[0]["title"].stringRef() == StringRef("First"), "document borrowed string");
+  check(results[1]["title"].escaped() && results[1]["title"].asString() == "Sec\"ond", "document escaped string");
+  check(results[0]["count"].asInt() == 3 && results[1]["count"].asFloat() == 2.5, "document numbers");
+  check(results[1]["tags"][0].asBool() && results[1]["tags"][1].type() == JSON::NIL, "document literals");
+  check(results[1]["tags"][2].type() == JSON::INT && results[1]["tags"][2].asUInt() == 12345678901234567890ULL,
+        "document unsigned integer");
+  check(!results[2].valid() && !results[0]["missing"].valid(), "document missing");
+
+  size_t members = 0;
+  for (JSON::Document::iterator i = results[1].begin(); i != results[1].end(); ++i) {
+    members++;
+  }
+  check(members == 4, "document iterator");
+  check(results[0].value().object_ref().toString() == "{\"count\":3,\"id\":\"a1\",\"title\":\"First\"}",
+        "document materialize");
+
+  // In place over a borrowed buffer.
+  std::shared_ptr<std::string> body = std::make_shared<std::string>("[1,{\"a\":\"b\"}]");
+  check(document.parse(body->data(), body->size(), body), "document borrowed parse");
+  check(document[1]["a"].stringRef().data() == body->data() + 9, "document zero copy");
+
+  check(!document.parse("{\"a\":1,}") && document.errorOffset() == 7, "document syntax error");
+  check(!document.parse("[1,2") && !document.root().valid(), "document truncated");
+}
+
+void test_scanning() {
+  JSON::Reader reader;
+  JSON::Handler ignore;
+  JSON::Document document;
+
+  // Long runs take the vectorized paths, the tails the scalar ones.
+  std::string padding(70, ' ');
+  std::string text = "[" + padding + "\"" + std::string(100, 'x') + "\\n\u00e4" + std::string(40, 'y') + "\"" + padding + "]";
+  check(reader.parse(text, ignore) == JSON::Reader::Complete, "long string");
+  check(document.parse(text) && document[0].asString().size() == 100 + 1 + 2 + 40, "long string document");
+
+  const char *valid[] = { "\"p\xc3\xa4iv\xc3\xa4\"", "\"\xe2\x82\xac\"", "\"\xf0\x9f\x98\x80 and more than thirty-two bytes of text\"" };
+  for (const char *v : valid) {
+    check(reader.parse(v, ignore) == JSON::Reader::Complete && document.parse(v), "valid UTF-8");
+  }
+  const char *invalid[] = { "\"\xc3\"", "\"\xc0\xaf\"", "\"\xed\xa0\x80\"", "\"\xf4\x90\x80\x80\"",
+                            "\"thirty-two bytes of plain ASCII text \xff\"" };
+  for (const char *v : invalid) {
+    check(reader.parse(v, ignore) == JSON::Reader::SyntaxError && !document.parse(v), "invalid UTF-8");
+  }
+
+  JSON::Value value = JSON::parseString("{ \"a\": [1, 2.5, \"x\"] }");
+  check(value["a"][2].as_string() == "x", "parseString");
+  bool thrown = false;
+  try {
+    JSON::parseString("{ \"a\": }");
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  check(thrown, "parseString syntax error");
+}
+
+/* Collects numbers as the handler sees them. */
+class NumberCollector : public JSON::Handler {
+public:
+  virtual bool integer(long long int aValue) { integers.push_back(aValue); return true; }
+  virtual bool unsignedInteger(unsigned long long int aValue) { unsigneds.push_back(aValue); return true; }
+  virtual bool number(double aValue) { floats.push_back(aValue); return true; }
+
+  std::vector<long long int> integers;
+  std::vector<unsigned long long int> unsigneds;
+  std::vector<double> floats;
+};
+
+void test_numbers() {
+  JSON::Reader reader;
+  NumberCollector numbers;
+
+  check(reader.parse("[2147483648, 1418985600000, -9223372036854775808, 9223372036854775807,"
+                     " 9223372036854775808, 18446744073709551615, 18446744073709551616,"
+                     " 0.1, 1e22, 1e23, -2.5e-3, 123456789012345678901234567890e-20, 1e400, 4.9e-324]",
+                     numbers) == JSON::Reader::Complete, "numbers parse");
+  check(numbers.integers.size() == 4 && numbers.integers[0] == 2147483648LL &&
+        numbers.integers[1] == 1418985600000LL &&
+        numbers.integers[2] == -9223372036854775807LL - 1 &&
+        numbers.integers[3] == 9223372036854775807LL, "64 bit integers");
+  check(numbers.unsigneds.size() == 2 && numbers.unsigneds[1] == 18446744073709551615ULL, "unsigned integers");
+  check(numbers.floats.size() == 8 && numbers.floats[0] == 18446744073709551616.0 &&
+        numbers.floats[1] == 0.1 && numbers.floats[2] == 1e22 && numbers.floats[3] == 1e23 &&
+        numbers.floats[4] == -2.5e-3 && numbers.floats[5] == 1234567890.1234567890 &&
+        numbers.floats[6] == HUGE_VAL && numbers.floats[7] == 4.9e-324, "floats");
+
+  // The fast path must agree with a correctly rounded conversion.
+  unsigned int seed = 12345;
+  bool exact = true;
+  for (int n = 0; n < 20000; ++n) {
+    seed = seed * 1103515245 + 12345;
+    unsigned long long int mantissa = ((unsigned long long int)seed << 20) ^ (seed >> 3);
+    int exponent = (int)(seed % 60) - 30;
+    char text[64];
+    snprintf(text, sizeof(text), "%llue%d", mantissa % 100000000000000ULL, exponent);
+    NumberCollector one;
+    reader.parse(text, one);
+    exact = exact && one.floats.size() == 1 && one.floats[0] == strtod(text, nullptr);
+  }
+  check(exact, "float conversion exact");
+
+  JSON::Value value = JSON::parseString("[18446744073709551615, 1.5]");
+  check(value[0].is_unsigned() && value[0].as_uint() == 18446744073709551615ULL, "unsigned value");
+  JSON::Writer writer;
+  writer.write(value);
+  check(writer.str() == "[18446744073709551615,1.5]", "unsigned round trip");
+
+  // A comma decimal point locale must not change the result.
+  if (setlocale(LC_NUMERIC, "de_DE.UTF-8") || setlocale(LC_NUMERIC, "fi_FI.UTF-8")) {
+    NumberCollector local;
+    reader.parse("[0.1, 3.14159265358979323846264338327950288]", local);
+    check(local.floats.size() == 2 && local.floats[0] == 0.1 && local.floats[1] == 3.141592653589793,
+          "locale independent");
+    setlocale(LC_NUMERIC, "C");
+  }
+}
+
+/* Records the last string reported. */
+class StringCollector : public JSON::Handler {
+public:
+  virtual bool string(const char *aData, size_t aLength) { last.assign(aData, aLength); pointer = aData; return true; }
+
+  std::string last;
+  const char *pointer;
+};
+
+void test_escapes() {
+  JSON::Reader reader;
+  JSON::Document document;
+  StringCollector strings;
+
+  std::string plain = "[\"no escapes here\"]";
+  check(reader.parse(plain, strings) == JSON::Reader::Complete && strings.pointer == plain.data() + 2,
+        "zero copy string");
+
+  std::string text = "[\"say \\\"hi\\\" \\/ \\b\\f\\n\\r\\t \\u00e4\\u20AC \\ud83d\\ude00" + std::string(40, '.') + "\"]";
+  std::string expected = std::string("say \"hi\" / \b\f\n\r\t \xc3\xa4\xe2\x82\xac \xf0\x9f\x98\x80") + std::string(40, '.');
+  check(reader.parse(text, strings) == JSON::Reader::Complete && strings.last == expected, "escapes");
+  check(document.parse(text) && document[0].asString() == expected, "document escapes");
+
+  const char *invalid[] = { "\"\\x\"", "\"\\u12\"", "\"\\ud83d\"", "\"\\ud83d\\u0041\"", "\"\\ude00\"",
+                            "\"tab\there\"", "\"new\nline\"" };
+  for (const char *v : invalid) {
+    check(reader.parse(v, strings) == JSON::Reader::SyntaxError && !document.parse(v), "invalid string");
+  }
+}
+
+struct Actor {
+  std::string name;
+  int born;
+};
+
+struct Movie {
+  std::string title;
+  unsigned short year;
+  double rating;
+  bool watched;
+  std::vector<Actor> actors;
+  std::vector<std::string> tags;
+};
+
+QTC_JSON_BINDING(Actor, name, born)
+QTC_JSON_BINDING(Movie, title, year, rating, watched, actors, tags)
+
+struct Flags {
+  std::vector<bool> bits;
+  int numberOfRetriesAllowed;
+};
+
+QTC_JSON_BINDING(Flags, bits, numberOfRetriesAllowed)
+
+void test_binding() {
+  JSON::Document document;
+  std::vector<Movie> movies;
+
+  check(document.parse("{ \"results\": [ { \"title\": \"Alien\", \"year\": 1979, \"rating\": 8,"
+                       " \"watched\": true, \"id\": \"x1\", \"tags\": [\"scifi\", \"hor\\u0072or\"],"
+                       " \"actors\": [ { \"name\": \"Sigourney Weaver\", \"born\": 1949 } ] },"
+                       " { \"title\": \"Up\", \"year\": 2009, \"rating\": 8.3, \"watched\": false } ] }"),
+        "binding parse");
+  check(JSON::decode(document["results"], movies) && movies.size() == 2, "binding decode");
+  check(movies[0].title == "Alien" && movies[0].year == 1979 && movies[0].rating == 8.0 && movies[0].watched,
+        "binding scalars");
+  check(movies[0].tags.size() == 2 && movies[0].tags[1] == "horror", "binding strings");
+  check(movies[0].actors.size() == 1 && movies[0].actors[0].born == 1949, "binding nested");
+  check(movies[1].rating == 8.3 && movies[1].actors.empty(), "binding missing members");
+
+  check(JSON::toString(movies[0]) ==
+        "{\"title\":\"Alien\",\"year\":1979,\"rating\":8.0,\"watched\":true,"
+        "\"actors\":[{\"name\":\"Sigourney Weaver\",\"born\":1949}],\"tags\":[\"scifi\",\"horror\"]}",
+        "binding encode");
+
+  Movie movie;
+  check(document.parse("{ \"title\": 1 }") && !JSON::decode(document, movie), "binding type mismatch");
+  check(document.parse("{ \"year\": 70000 }") && !JSON::decode(document, movie), "binding range");
+
+  Flags flags;
+  check(document.parse("{ \"bits\": [true, false, true], \"numberOfRetries\\u0041llowed\": 3, \"bits2\": 1 }") &&
+        JSON::decode(document, flags) && flags.bits.size() == 3 && flags.bits[2] && !flags.bits[1] &&
+        flags.numberOfRetriesAllowed == 3, "binding bool vector and escaped key");
+}
+
+void test_path() {
+  const std::string text =
+    "{ \"results\": [ { \"owner\": { \"id\": \"u1\" }, \"a/b\": 1, \"m~n\": 2 },"
+    "                { \"owner\": { \"id\": \"u2\" } },"
+    "                { \"owner\": 7 },"
+    "                { \"owner\": { \"id\": \"u3\" } } ] }";
+  JSON::Value value = JSON::parseString(text);
+  JSON::Document document;
+  document.parse(text);
+
+  JSON::Path ids("/results/*/owner/id");
+  std::vector<const JSON::Value*> values;
+  std::vector<JSON::Document::Node> nodes;
+  check(ids.isValid() && ids.select(value, values) == 3 && values[2]->as_string() == "u3", "path select value");
+  check(ids.select(document.root(), nodes) == 3 && nodes[1].asString() == "u2", "path select document");
+
+  check(JSON::Path("/results/1/owner/id").find(value)->as_string() == "u2", "path index");
+  check(JSON::Path("/results/0/a~1b").find(document.root()).asInt() == 1 &&
+        JSON::Path("/results/0/m~0n").find(value)->as_int() == 2, "path escapes");
+  check(JSON::Path("/results/*/owner/id").find(value)->as_string() == "u1", "path first match");
+  check(JSON::Path("").find(value) == &value, "path root");
+  check(JSON::Path("/results/9/owner").find(value) == nullptr &&
+        !JSON::Path("/results/2/owner/id").find(document.root()).valid() &&
+        JSON::Path("/results/01").find(value) == nullptr, "path no match");
+  check(!JSON::Path("results").isValid() && !JSON::Path("/a~2").isValid(), "path invalid");
+}
+
+void test_files() {
+  const char *filename = "TestingJSON.tmp.json";
+  FILE *file = fopen(filename, "wb");
+  fputs("{ \"results\": [ { \"title\": \"mapped\" } ] }", file);
+  fclose(file);
+
+  JSON::Value value = JSON::parseFile(filename);
+  check(value["results"][0]["title"].as_string() == "mapped", "parseFile");
+
+  JSON::Document document;
+  check(document.parseFile(filename) && document["results"][0]["title"].stringRef() == StringRef("mapped"),
+        "document parseFile");
+  remove(filename);
+  check(document["results"][0]["title"].asString() == "mapped", "document keeps mapping");
+
+  bool thrown = false;
+  try {
+    JSON::parseFile(filename);
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  check(thrown && !document.parseFile(filename), "parseFile missing file");
+
+#if !defined(_WIN32)
+  // A pipe has no size to map, it is read through instead.
+  check(mkfifo(filename, 0600) == 0, "mkfifo");
+  pid_t writer = fork();
+  if (writer == 0) {
+    FILE *fifo = fopen(filename, "wb");
+    fputs("{ \"piped\": [1, 2] }", fifo);
+    fclose(fifo);
+    _exit(0);
+  }
+  value = JSON::parseFile(filename);
+  waitpid(writer, nullptr, 0);
+  remove(filename);
+  check(value["piped"][1].as_int() == 2, "parseFile pipe");
+#endif
+}
+
+struct BytesCollector : public JSON::ValueBuilder {
+  std::string binary;
+  const char *pointer;
+  BytesCollector() : pointer(nullptr) {}
+  bool string(const char *aData, size_t aLength) { pointer = aData; return JSON::ValueBuilder::string(aData, aLength); }
+  bool bytes(const char *aData, size_t aLength) { binary.assign(aData, aLength); return JSON::ValueBuilder::null(); }
+};
+
+void test_cbor() {
+  const std::string text =
+    "{\"name\":\"caf\\u00e9\",\"n\":[0,23,24,-1,-1000,1.5,0.1,true,false,null],"
+    "\"big\":18446744073709551615,\"low\":-9223372036854775808,\"nested\":{\"empty\":[],\"o\":{}}}";
+  JSON::Value value = JSON::parseString(text);
+  std::string encoded = JSON::toCBOR(value);
+  JSON::Value decoded = JSON::parseCBOR(encoded);
+  check(JSON::toString(decoded) == JSON::toString(value), "cbor round trip");
+  check(decoded["big"].is_unsigned() && decoded["big"].as_uint() == 18446744073709551615ULL &&
+        decoded["low"].as_int() == (-9223372036854775807LL - 1), "cbor integer range");
+  check(decoded["n"][6].as_float() == 0.1 && decoded["n"][5].as_float() == 1.5, "cbor floats");
+  check(encoded.size() < JSON::toString(value).size(), "cbor compact");
+
+  // RFC 8949 appendix A
+  check(JSON::toCBOR(JSON::Value(0)) == std::string("\x00", 1) &&
+        JSON::toCBOR(JSON::Value(24)) == "\x18\x18" &&
+        JSON::toCBOR(JSON::Value(1000)) == "\x19\x03\xe8" &&
+        JSON::toCBOR(JSON::Value(-1000)) == "\x39\x03\xe7" &&
+        JSON::toCBOR(JSON::Value(1.5)) == std::string("\xfa\x3f\xc0\x00\x00", 5) &&
+        JSON::toCBOR(JSON::Value(1.1)) == "\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a" &&
+        JSON::toCBOR(JSON::Value("IETF")) == "\x64IETF", "cbor encode");
+  check(JSON::toCBOR(JSON::Value(1e300)).size() == 9 && JSON::parseCBOR(JSON::toCBOR(JSON::Value(-1e300))).as_float() == -1e300 &&
+        JSON::toCBOR(JSON::Value(HUGE_VAL)) == std::string("\xfa\x7f\x80\x00\x00", 5), "cbor beyond float range");
+  check(JSON::parseCBOR(std::string("\xf9\x3c\x00", 3)).as_float() == 1.0 &&
+        JSON::parseCBOR("\xf9\x7b\xff").as_float() == 65504.0 &&
+        JSON::parseCBOR("\x3b\xff\xff\xff\xff\xff\xff\xff\xff").as_float() == -18446744073709551616.0 &&
+        JSON::parseCBOR("\xc1\x1a\x51\x4b\x67\xb0").as_int() == 1363896240 &&
+        JSON::parseCBOR("\xf7").type() == JSON::NIL, "cbor decode");
+
+  // Indefinite lengths, written by the streaming interface
+  JSON::CBORWriter writer;
+  writer.beginObject().key("a").beginArray().integer(1).integer(2).endArray().endObject();
+  check(writer.str() == "\xbf\x61\x61\x9f\x01\x02\xff\xff", "cbor indefinite encode");
+  check(JSON::toString(JSON::parseCBOR(writer.str())) == "{\"a\":[1,2]}", "cbor indefinite decode");
+  check(JSON::parseCBOR("\x7f\x65strea\x64ming\xff").as_string() == "streaming", "cbor chunked string");
+
+  JSON::CBORReader reader;
+  BytesCollector collector;
+  std::string data = "\x82\x43\x01\x02\x03\x62hi";
+  check(reader.parse(data, collector) == JSON::Reader::Complete && collector.binary == "\x01\x02\x03" &&
+        collector.pointer == data.data() + 6, "cbor zero copy");
+
+  JSON::ValueBuilder builder;
+  check(reader.parse(std::string("\x82\x01", 2), builder) == JSON::Reader::SyntaxError, "cbor truncated");
+  check(reader.parse(std::string("\xa1\x01\x02", 3), builder) == JSON::Reader::SyntaxError &&
+        reader.errorOffset() == 1, "cbor non text key");
+  check(reader.parse(std::string("\x01\x02", 2), builder) == JSON::Reader::SyntaxError, "cbor trailing data");
+  check(reader.parse(std::string("\x62\xc3\x28", 3), builder) == JSON::Reader::SyntaxError, "cbor invalid utf8");
+  check(reader.parse(std::string("\x5a\xff\xff\xff\xff", 5), builder) == JSON::Reader::SyntaxError, "cbor length");
+  check(reader.parse(std::string("\xbf\x61\x61\xff", 4), builder) == JSON::Reader::SyntaxError, "cbor missing value");
+}
+
+void test_patch() {
+  JSON::Value before = JSON::parseString(
+    "{\"title\":\"Alien\",\"year\":1979,\"tags\":[\"scifi\"],\"cast\":{\"lead\":\"Weaver\",\"extra\":\"Hurt\"},\"old\":1}");
+  JSON::Value after = JSON::parseString(
+    "{\"title\":\"Alien\",\"year\":1980,\"tags\":[\"scifi\",\"horror\"],\"cast\":{\"lead\":\"Weaver\"},\"new\":true}");
+
+  JSON::Object patch = JSON::diff(before.object_ref(), after.object_ref());
+  check(patch.toString() ==
+        "{\"cast\":{\"extra\":null},\"new\":true,\"old\":null,\"tags\":[\"scifi\",\"horror\"],\"year\":1980}",
+        "diff");
+  check(JSON::diff(after.object_ref(), after.object_ref()).size() == 0, "diff unchanged");
+
+  JSON::Value merged = before;
+  JSON::merge(merged, JSON::Value(patch));
+  check(JSON::toString(merged) == JSON::toString(after), "merge");
+
+  // RFC 7386 appendix A
+  JSON::Value target = JSON::parseString("{\"a\":[{\"b\":\"c\"}]}");
+  JSON::merge(target, JSON::parseString("{\"a\":{\"b\":\"d\",\"c\":null}}"));
+  check(JSON::toString(target) == "{\"a\":{\"b\":\"d\"}}", "merge replaces non object");
+  JSON::merge(target, JSON::parseString("[1]"));
+  check(JSON::toString(target) == "[1]", "merge non object patch");
+  JSON::merge(target, JSON::parseString("{\"e\":null}"));
+  check(JSON::toString(target) == "{}", "merge into non object");
+}
+
+void test_equality() {
+  const std::string text = "{\"a\":[1,2.5,\"x\",null,true],\"b\":{\"c\":-0.0,\"d\":18446744073709551615}}";
+  JSON::Value left = JSON::parseString(text);
+  JSON::Value right = JSON::parseString(text);
+  check(left == right && left.hash() == right.hash(), "equal values");
+  check(JSON::Value(0.0).hash() == JSON::Value(-0.0).hash(), "hash signed zero");
+  check(JSON::Value(1) != JSON::Value(1.0) && JSON::Value(1) != JSON::Value("1") &&
+        JSON::Value(-1) != JSON::Value(18446744073709551615ULL), "unequal types");
+
+  unsigned long long int hash = left.hash();
+  left["b"]["d"] = JSON::Value(1);
+  check(left != right && left.hash() != hash, "hash invalidated");
+  left["b"]["d"] = JSON::Value(18446744073709551615ULL);
+  check(left == right && left.hash() == hash, "hash recomputed");
+  left["a"][1] = JSON::Value(2.25);
+  check(left != right && left.hash() != hash, "array hash invalidated");
+
+  // A write through a reference taken before hashing must not leave a stale hash.
+  JSON::Value root = JSON::parseString("{\"x\":{\"y\":1}}");
+  JSON::Value &child = root["x"];
+  JSON::Value &leaf = child["y"];
+  hash = root.hash();
+  child["y"] = JSON::Value(2);
+  JSON::Value expected = JSON::parseString("{\"x\":{\"y\":2}}");
+  check(root == expected && root.hash() == expected.hash() && root.hash() != hash, "retained child reference");
+  leaf = JSON::Value(3);
+  check(root != expected && root == JSON::parseString("{\"x\":{\"y\":3}}") &&
+        JSON::Value(JSON::diff(expected.object_ref(), root.object_ref())).hash() ==
+        JSON::parseString("{\"x\":{\"y\":3}}").hash(), "retained leaf reference");
+
+  std::unordered_set<JSON::Value> queries;
+  queries.insert(JSON::parseString("{\"name\":\"a\"}"));
+  queries.insert(JSON::parseString("{ \"name\" : \"a\" }"));
+  queries.insert(JSON::parseString("{\"name\":\"b\"}"));
+  check(queries.size() == 2, "hash set");
+}
+
+void test_sharing() {
+  JSON::Value original = JSON::parseString("{\"results\":[{\"id\":\"a\"},{\"id\":\"b\"}]}");
+  const JSON::Value &results = static_cast<const JSON::Value &>(original)["results"];
+  JSON::Value copy = original;
+  JSON::Array array = results;
+  const JSON::Array &shared = array;
+  check(original.object_ref().shared() && array.shared() && &shared[0] == &results.array_ref()[0],
+        "copies share");
+
+  copy["results"][1]["id"] = JSON::Value("c");
+  check(original["results"][1]["id"].as_string() == "b" && copy["results"][1]["id"].as_string() == "c",
+        "copy on write");
+  array.push_back(JSON::Value(1));
+  check(array.size() == 3 && original["results"].array_ref().size() == 2 && !array.shared(), "array copy on write");
+
+  JSON::Object empty;
+  check(empty.size() == 0 && empty.begin() == empty.end() && empty.find("x") == empty.end() &&
+        empty.erase("x") == 0 && !empty.shared(), "empty object");
+
+  // A mutable reference handed out before a copy must not reach the copy.
+  JSON::Object object;
+  object.insert(JSON::Key("a"), JSON::Value(1));
+  JSON::Value &a = object["a"];
+  JSON::Object objectCopy = object;
+  a = JSON::Value(5);
+  check(!object.shared() && objectCopy["a"].as_int() == 1 && object["a"].as_int() == 5, "unsharable object");
+
+  JSON::Array list = { JSON::Value(1), JSON::Value(2) };
+  JSON::Array::Container::iterator first = list.begin();
+  JSON::Array listCopy;
+  listCopy = list;
+  *first = JSON::Value(5);
+  check(listCopy[0].as_int() == 1 && list[0].as_int() == 5, "unsharable array");
+
+  JSON::Value parsed = JSON::parseString("{\"a\":{\"b\":[1]}}");
+  JSON::Value parsedCopy = parsed;
+  check(parsed.object_ref().shared(), "parsed objects stay sharable");
+}
+
+int main() {
+  cout << "Testing.." << endl;
+
+  test_writer();
+  test_reader();
+  test_keys();
+  test_incremental();
+  test_document();
+  test_scanning();
+  test_numbers();
+  test_escapes();
+  test_binding();
+  test_path();
+  test_files();
+  test_cbor();
+  test_patch();
+  test_equality();
+  test_sharing();
+
+  cout << (failures ? "FAILED" : "OK") << endl;
+  return failures ? 1 : 0;
+}